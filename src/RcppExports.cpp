@@ -11,61 +11,362 @@ Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
 // dedistance
-NumericVector dedistance(NumericVector& distances, int points_size);
-RcppExport SEXP _hclust1d_dedistance(SEXP distancesSEXP, SEXP points_sizeSEXP) {
+NumericVector dedistance(NumericVector& distances, int points_size, bool squared);
+RcppExport SEXP _hclust1d_dedistance(SEXP distancesSEXP, SEXP points_sizeSEXP, SEXP squaredSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< NumericVector& >::type distances(distancesSEXP);
     Rcpp::traits::input_parameter< int >::type points_size(points_sizeSEXP);
-    rcpp_result_gen = Rcpp::wrap(dedistance(distances, points_size));
+    Rcpp::traits::input_parameter< bool >::type squared(squaredSEXP);
+    rcpp_result_gen = Rcpp::wrap(dedistance(distances, points_size, squared));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dedistance_file
+NumericVector dedistance_file(std::string path, int points_size, bool squared, RObject labels);
+RcppExport SEXP _hclust1d_dedistance_file(SEXP pathSEXP, SEXP points_sizeSEXP, SEXP squaredSEXP, SEXP labelsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< int >::type points_size(points_sizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type squared(squaredSEXP);
+    Rcpp::traits::input_parameter< RObject >::type labels(labelsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dedistance_file(path, points_size, squared, labels));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hclust1d_batch
+List hclust1d_batch(List& points_list, int method, CharacterVector& method_name, RObject call, int threads, bool columnar, int queue);
+RcppExport SEXP _hclust1d_hclust1d_batch(SEXP points_listSEXP, SEXP methodSEXP, SEXP method_nameSEXP, SEXP callSEXP, SEXP threadsSEXP, SEXP columnarSEXP, SEXP queueSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List& >::type points_list(points_listSEXP);
+    Rcpp::traits::input_parameter< int >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< CharacterVector& >::type method_name(method_nameSEXP);
+    Rcpp::traits::input_parameter< RObject >::type call(callSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type columnar(columnarSEXP);
+    Rcpp::traits::input_parameter< int >::type queue(queueSEXP);
+    rcpp_result_gen = Rcpp::wrap(hclust1d_batch(points_list, method, method_name, call, threads, columnar, queue));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hclust1d_bootstrap
+SEXP hclust1d_bootstrap(NumericVector& points, int resamples, int method, int k, IntegerVector& seed, bool coclustering, int threads, int queue);
+RcppExport SEXP _hclust1d_hclust1d_bootstrap(SEXP pointsSEXP, SEXP resamplesSEXP, SEXP methodSEXP, SEXP kSEXP, SEXP seedSEXP, SEXP coclusteringSEXP, SEXP threadsSEXP, SEXP queueSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< int >::type resamples(resamplesSEXP);
+    Rcpp::traits::input_parameter< int >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< IntegerVector& >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< bool >::type coclustering(coclusteringSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type queue(queueSEXP);
+    rcpp_result_gen = Rcpp::wrap(hclust1d_bootstrap(points, resamples, method, k, seed, coclustering, threads, queue));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hclust1d_cut
+IntegerMatrix hclust1d_cut(NumericVector& points, int method, IntegerVector& k, NumericVector& h, int queue);
+RcppExport SEXP _hclust1d_hclust1d_cut(SEXP pointsSEXP, SEXP methodSEXP, SEXP kSEXP, SEXP hSEXP, SEXP queueSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< int >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< IntegerVector& >::type k(kSEXP);
+    Rcpp::traits::input_parameter< NumericVector& >::type h(hSEXP);
+    Rcpp::traits::input_parameter< int >::type queue(queueSEXP);
+    rcpp_result_gen = Rcpp::wrap(hclust1d_cut(points, method, k, h, queue));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dynamic_dendrogram_create
+SEXP dynamic_dendrogram_create(int method);
+RcppExport SEXP _hclust1d_dynamic_dendrogram_create(SEXP methodSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(dynamic_dendrogram_create(method));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dynamic_insert
+IntegerVector dynamic_insert(SEXP dendrogram, NumericVector& points);
+RcppExport SEXP _hclust1d_dynamic_insert(SEXP dendrogramSEXP, SEXP pointsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type dendrogram(dendrogramSEXP);
+    Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dynamic_insert(dendrogram, points));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dynamic_delete
+void dynamic_delete(SEXP dendrogram, IntegerVector& ids);
+RcppExport SEXP _hclust1d_dynamic_delete(SEXP dendrogramSEXP, SEXP idsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type dendrogram(dendrogramSEXP);
+    Rcpp::traits::input_parameter< IntegerVector& >::type ids(idsSEXP);
+    dynamic_delete(dendrogram, ids);
+    return R_NilValue;
+END_RCPP
+}
+// dynamic_hclust
+List dynamic_hclust(SEXP dendrogram, int queue);
+RcppExport SEXP _hclust1d_dynamic_hclust(SEXP dendrogramSEXP, SEXP queueSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type dendrogram(dendrogramSEXP);
+    Rcpp::traits::input_parameter< int >::type queue(queueSEXP);
+    rcpp_result_gen = Rcpp::wrap(dynamic_hclust(dendrogram, queue));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hclust1d_file
+double hclust1d_file(std::string points, std::string merges, std::string order, double memory, std::string temporary);
+RcppExport SEXP _hclust1d_hclust1d_file(SEXP pointsSEXP, SEXP mergesSEXP, SEXP orderSEXP, SEXP memorySEXP, SEXP temporarySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type merges(mergesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type order(orderSEXP);
+    Rcpp::traits::input_parameter< double >::type memory(memorySEXP);
+    Rcpp::traits::input_parameter< std::string >::type temporary(temporarySEXP);
+    rcpp_result_gen = Rcpp::wrap(hclust1d_file(points, merges, order, memory, temporary));
     return rcpp_result_gen;
 END_RCPP
 }
 // hclust1d_heapbased
-List hclust1d_heapbased(NumericVector& points, int method);
-RcppExport SEXP _hclust1d_hclust1d_heapbased(SEXP pointsSEXP, SEXP methodSEXP) {
+List hclust1d_heapbased(NumericVector& points, int method, int queue, int labels, SEXP workspace, bool profile);
+RcppExport SEXP _hclust1d_hclust1d_heapbased(SEXP pointsSEXP, SEXP methodSEXP, SEXP queueSEXP, SEXP labelsSEXP, SEXP workspaceSEXP, SEXP profileSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
     Rcpp::traits::input_parameter< int >::type method(methodSEXP);
-    rcpp_result_gen = Rcpp::wrap(hclust1d_heapbased(points, method));
+    Rcpp::traits::input_parameter< int >::type queue(queueSEXP);
+    Rcpp::traits::input_parameter< int >::type labels(labelsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type workspace(workspaceSEXP);
+    Rcpp::traits::input_parameter< bool >::type profile(profileSEXP);
+    rcpp_result_gen = Rcpp::wrap(hclust1d_heapbased(points, method, queue, labels, workspace, profile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// cut_index_create
+SEXP cut_index_create(NumericVector& points, IntegerMatrix& merge, IntegerVector& clusters);
+RcppExport SEXP _hclust1d_cut_index_create(SEXP pointsSEXP, SEXP mergeSEXP, SEXP clustersSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< IntegerMatrix& >::type merge(mergeSEXP);
+    Rcpp::traits::input_parameter< IntegerVector& >::type clusters(clustersSEXP);
+    rcpp_result_gen = Rcpp::wrap(cut_index_create(points, merge, clusters));
+    return rcpp_result_gen;
+END_RCPP
+}
+// cut_index_predict
+IntegerMatrix cut_index_predict(SEXP index, NumericVector& points, int threads);
+RcppExport SEXP _hclust1d_cut_index_predict(SEXP indexSEXP, SEXP pointsSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(cut_index_predict(index, points, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hclust1d_multi
+List hclust1d_multi(NumericVector& points, IntegerVector& methods, int threads, int queue, bool heap_only, int labels, SEXP workspace, bool profile);
+RcppExport SEXP _hclust1d_hclust1d_multi(SEXP pointsSEXP, SEXP methodsSEXP, SEXP threadsSEXP, SEXP queueSEXP, SEXP heap_onlySEXP, SEXP labelsSEXP, SEXP workspaceSEXP, SEXP profileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< IntegerVector& >::type methods(methodsSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type queue(queueSEXP);
+    Rcpp::traits::input_parameter< bool >::type heap_only(heap_onlySEXP);
+    Rcpp::traits::input_parameter< int >::type labels(labelsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type workspace(workspaceSEXP);
+    Rcpp::traits::input_parameter< bool >::type profile(profileSEXP);
+    rcpp_result_gen = Rcpp::wrap(hclust1d_multi(points, methods, threads, queue, heap_only, labels, workspace, profile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hclust1d_nnchain
+List hclust1d_nnchain(NumericVector& points, int method, int threads, int labels, SEXP workspace, bool profile);
+RcppExport SEXP _hclust1d_hclust1d_nnchain(SEXP pointsSEXP, SEXP methodSEXP, SEXP threadsSEXP, SEXP labelsSEXP, SEXP workspaceSEXP, SEXP profileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< int >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type labels(labelsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type workspace(workspaceSEXP);
+    Rcpp::traits::input_parameter< bool >::type profile(profileSEXP);
+    rcpp_result_gen = Rcpp::wrap(hclust1d_nnchain(points, method, threads, labels, workspace, profile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hclust1d_save
+void hclust1d_save(IntegerMatrix& merge, NumericVector& height, IntegerVector& order, SEXP labels, std::string method, std::string dist_method, std::string path);
+RcppExport SEXP _hclust1d_hclust1d_save(SEXP mergeSEXP, SEXP heightSEXP, SEXP orderSEXP, SEXP labelsSEXP, SEXP methodSEXP, SEXP dist_methodSEXP, SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< IntegerMatrix& >::type merge(mergeSEXP);
+    Rcpp::traits::input_parameter< NumericVector& >::type height(heightSEXP);
+    Rcpp::traits::input_parameter< IntegerVector& >::type order(orderSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type labels(labelsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< std::string >::type dist_method(dist_methodSEXP);
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    hclust1d_save(merge, height, order, labels, method, dist_method, path);
+    return R_NilValue;
+END_RCPP
+}
+// hclust1d_save_points
+void hclust1d_save_points(NumericVector& points, int method, int threads, int queue, bool heap_only, int labels, SEXP workspace, std::string method_name, std::string dist_method, std::string path);
+RcppExport SEXP _hclust1d_hclust1d_save_points(SEXP pointsSEXP, SEXP methodSEXP, SEXP threadsSEXP, SEXP queueSEXP, SEXP heap_onlySEXP, SEXP labelsSEXP, SEXP workspaceSEXP, SEXP method_nameSEXP, SEXP dist_methodSEXP, SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< int >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type queue(queueSEXP);
+    Rcpp::traits::input_parameter< bool >::type heap_only(heap_onlySEXP);
+    Rcpp::traits::input_parameter< int >::type labels(labelsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type workspace(workspaceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type method_name(method_nameSEXP);
+    Rcpp::traits::input_parameter< std::string >::type dist_method(dist_methodSEXP);
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    hclust1d_save_points(points, method, threads, queue, heap_only, labels, workspace, method_name, dist_method, path);
+    return R_NilValue;
+END_RCPP
+}
+// hclust1d_load
+List hclust1d_load(std::string path);
+RcppExport SEXP _hclust1d_hclust1d_load(SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(hclust1d_load(path));
     return rcpp_result_gen;
 END_RCPP
 }
 // hclust1d_single
-List hclust1d_single(NumericVector& points);
-RcppExport SEXP _hclust1d_hclust1d_single(SEXP pointsSEXP) {
+List hclust1d_single(NumericVector& points, int threads, int labels, SEXP workspace, bool profile);
+RcppExport SEXP _hclust1d_hclust1d_single(SEXP pointsSEXP, SEXP threadsSEXP, SEXP labelsSEXP, SEXP workspaceSEXP, SEXP profileSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
-    rcpp_result_gen = Rcpp::wrap(hclust1d_single(points));
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type labels(labelsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type workspace(workspaceSEXP);
+    Rcpp::traits::input_parameter< bool >::type profile(profileSEXP);
+    rcpp_result_gen = Rcpp::wrap(hclust1d_single(points, threads, labels, workspace, profile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// window_create
+SEXP window_create(int size, int method);
+RcppExport SEXP _hclust1d_window_create(SEXP sizeSEXP, SEXP methodSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type size(sizeSEXP);
+    Rcpp::traits::input_parameter< int >::type method(methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(window_create(size, method));
+    return rcpp_result_gen;
+END_RCPP
+}
+// window_slide
+IntegerVector window_slide(SEXP window, NumericVector& points, int k, double h, int queue);
+RcppExport SEXP _hclust1d_window_slide(SEXP windowSEXP, SEXP pointsSEXP, SEXP kSEXP, SEXP hSEXP, SEXP queueSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type window(windowSEXP);
+    Rcpp::traits::input_parameter< NumericVector& >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< double >::type h(hSEXP);
+    Rcpp::traits::input_parameter< int >::type queue(queueSEXP);
+    rcpp_result_gen = Rcpp::wrap(window_slide(window, points, k, h, queue));
+    return rcpp_result_gen;
+END_RCPP
+}
+// window_hclust
+List window_hclust(SEXP window, int queue);
+RcppExport SEXP _hclust1d_window_hclust(SEXP windowSEXP, SEXP queueSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type window(windowSEXP);
+    Rcpp::traits::input_parameter< int >::type queue(queueSEXP);
+    rcpp_result_gen = Rcpp::wrap(window_hclust(window, queue));
     return rcpp_result_gen;
 END_RCPP
 }
-// sqrt
-NumericVector sqrt(NumericVector& squared_distances);
-RcppExport SEXP _hclust1d_sqrt(SEXP squared_distancesSEXP) {
+// hclust1d_workspace_create
+SEXP hclust1d_workspace_create();
+RcppExport SEXP _hclust1d_hclust1d_workspace_create() {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector& >::type squared_distances(squared_distancesSEXP);
-    rcpp_result_gen = Rcpp::wrap(sqrt(squared_distances));
+    rcpp_result_gen = Rcpp::wrap(hclust1d_workspace_create());
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_hclust1d_dedistance", (DL_FUNC) &_hclust1d_dedistance, 2},
-    {"_hclust1d_hclust1d_heapbased", (DL_FUNC) &_hclust1d_hclust1d_heapbased, 2},
-    {"_hclust1d_hclust1d_single", (DL_FUNC) &_hclust1d_hclust1d_single, 1},
-    {"_hclust1d_sqrt", (DL_FUNC) &_hclust1d_sqrt, 1},
+    {"_hclust1d_dedistance", (DL_FUNC) &_hclust1d_dedistance, 3},
+    {"_hclust1d_dedistance_file", (DL_FUNC) &_hclust1d_dedistance_file, 4},
+    {"_hclust1d_hclust1d_batch", (DL_FUNC) &_hclust1d_hclust1d_batch, 7},
+    {"_hclust1d_hclust1d_bootstrap", (DL_FUNC) &_hclust1d_hclust1d_bootstrap, 8},
+    {"_hclust1d_hclust1d_cut", (DL_FUNC) &_hclust1d_hclust1d_cut, 5},
+    {"_hclust1d_dynamic_dendrogram_create", (DL_FUNC) &_hclust1d_dynamic_dendrogram_create, 1},
+    {"_hclust1d_dynamic_insert", (DL_FUNC) &_hclust1d_dynamic_insert, 2},
+    {"_hclust1d_dynamic_delete", (DL_FUNC) &_hclust1d_dynamic_delete, 2},
+    {"_hclust1d_dynamic_hclust", (DL_FUNC) &_hclust1d_dynamic_hclust, 2},
+    {"_hclust1d_hclust1d_file", (DL_FUNC) &_hclust1d_hclust1d_file, 5},
+    {"_hclust1d_hclust1d_heapbased", (DL_FUNC) &_hclust1d_hclust1d_heapbased, 6},
+    {"_hclust1d_cut_index_create", (DL_FUNC) &_hclust1d_cut_index_create, 3},
+    {"_hclust1d_cut_index_predict", (DL_FUNC) &_hclust1d_cut_index_predict, 3},
+    {"_hclust1d_hclust1d_multi", (DL_FUNC) &_hclust1d_hclust1d_multi, 8},
+    {"_hclust1d_hclust1d_nnchain", (DL_FUNC) &_hclust1d_hclust1d_nnchain, 6},
+    {"_hclust1d_hclust1d_save", (DL_FUNC) &_hclust1d_hclust1d_save, 7},
+    {"_hclust1d_hclust1d_save_points", (DL_FUNC) &_hclust1d_hclust1d_save_points, 10},
+    {"_hclust1d_hclust1d_load", (DL_FUNC) &_hclust1d_hclust1d_load, 1},
+    {"_hclust1d_hclust1d_single", (DL_FUNC) &_hclust1d_hclust1d_single, 5},
+    {"_hclust1d_window_create", (DL_FUNC) &_hclust1d_window_create, 2},
+    {"_hclust1d_window_slide", (DL_FUNC) &_hclust1d_window_slide, 5},
+    {"_hclust1d_window_hclust", (DL_FUNC) &_hclust1d_window_hclust, 2},
+    {"_hclust1d_hclust1d_workspace_create", (DL_FUNC) &_hclust1d_hclust1d_workspace_create, 0},
     {NULL, NULL, 0}
 };
 
+void init_dendrogram_file(DllInfo* dll);
+void init_point_labels(DllInfo* dll);
 RcppExport void R_init_hclust1d(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    init_dendrogram_file(dll);
+    init_point_labels(dll);
 }
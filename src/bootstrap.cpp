@@ -0,0 +1,217 @@
+#include <vector>  //std::vector
+#include <random>  //std::mt19937_64, std::seed_seq
+#include <cstdint>  //std::uint32_t, std::uint64_t, std::int64_t
+#include <algorithm>  //std::fill, std::copy, std::min, std::max
+#include <numeric>  //std::iota
+#include <limits>  //std::numeric_limits
+#include "bootstrap.h"
+#include "order.h"
+#include "multi.h"
+#include "parallel.h"
+
+void bootstrap_counts(int points_size, const std::uint32_t * seed, int resample, int * counts) {
+  std::seed_seq sequence = {seed[0], seed[1], (std::uint32_t)resample};
+  std::mt19937_64 generator(sequence);
+  std::fill(counts, counts + points_size, 0);
+  for (int i = 0; i < points_size; i++)
+    counts[((generator() >> 32) * (std::uint64_t)points_size) >> 32]++;   //uniform, up to a bias of points_size / 2^32
+}
+
+//the buffers of a worker, reused from one resample to the next
+struct bootstrap_workspace {
+  std::vector<int> counts;   //by the index of the point
+  std::vector<double> resample;   //in the sorted order
+  std::vector<int> order_resample;   //0 .. points_size - 1, as the resample is sorted already
+  std::vector<int> first_copies;   //the position of the first copy of each sorted point in the resample, or -1
+  std::vector<int> merge_left;
+  std::vector<int> merge_right;
+  std::vector<double> height;
+  std::vector<int> rightmost;   //the rightmost point of the cluster merged at each stage
+  std::vector<char> breakpoints;   //by the interval
+  std::vector<int> clusters;   //by the position in the resample
+  std::vector<int> times_drawn;   //of a block of rows of the sorted points, over a batch of resamples
+  std::vector<int> pairs_drawn;   //of the rows with the points after the first one
+  std::vector<int> pairs_together;
+  struct hclust1d_workspace loops;
+};
+
+static void cluster_resample(const int * order_points, const double * sorted_points, int points_size, int resample,
+                             int method, int k, const std::uint32_t * seed, int queue, bootstrap_workspace & w) {
+  w.counts.resize(points_size);
+  bootstrap_counts(points_size, seed, resample, w.counts.data());
+
+  w.resample.resize(points_size);
+  w.first_copies.resize(points_size);
+  int position = 0;
+  for (int p = 0; p < points_size; p++) {
+    int count = w.counts[order_points[p]];
+    w.first_copies[p] = count > 0 ? position : -1;
+    for (; count > 0; count--)
+      w.resample[position++] = sorted_points[p];
+  }
+
+  w.order_resample.resize(points_size);
+  std::iota(w.order_resample.begin(), w.order_resample.end(), 0);
+  w.merge_left.resize(points_size - 1);
+  w.merge_right.resize(points_size - 1);
+  w.height.resize(points_size - 1);
+  linkage_dendrogram d = {method, w.merge_left.data(), w.merge_right.data(), w.height.data(), NULL};
+  linkage_merges_sorted(w.order_resample.data(), w.resample.data(), points_size, d, 1, queue, false, w.loops);
+
+  //the interval merged at a stage lies right after the rightmost point of its left cluster,
+  //and the intervals merged at the last k - 1 stages are the breakpoints of the cut
+  w.rightmost.resize(points_size - 1);
+  w.breakpoints.assign(points_size - 1, 0);
+  for (int stage = 0; stage < points_size - 1; stage++) {
+    int left = w.merge_left[stage];
+    int right = w.merge_right[stage];
+    int id = left < 0 ? -left - 1 : w.rightmost[left - 1];
+    w.rightmost[stage] = right < 0 ? -right - 1 : w.rightmost[right - 1];
+    if (stage >= points_size - k)
+      w.breakpoints[id] = 1;
+  }
+
+  w.clusters.resize(points_size);
+  w.clusters[0] = 1;
+  for (int i = 1; i < points_size; i++)
+    w.clusters[i] = w.clusters[i - 1] + w.breakpoints[i - 1];
+}
+
+//a batch of resamples kept for the co-clustering, each in points_size values of each vector:
+//the sorted points drawn (their positions, ascending, and their clusters) and the rank of each sorted point among them
+struct resample_batch {
+  std::vector<int> drawn_size;   //by the resample
+  std::vector<int> drawn_positions;
+  std::vector<int> drawn_clusters;
+  std::vector<int> ranks;   //-1 for the points not drawn
+};
+
+//the pairs of the sorted points first .. last - 1 with the points after them, over a batch of resamples: the resamples
+//drawing both points of a pair are added to one of the two cells of the pair in coclustering, and those putting them
+//in the same cluster to the other one. The clusters are intervals of the sorted points, so the points drawn
+//in the cluster of a point are those right after it. The rows go together through each resample, while it is in cache
+static void count_pairs(const int * order_points, int points_size, const resample_batch & batch, int batch_size,
+                        int first, int last, bootstrap_workspace & w, double * coclustering) {
+  int width = points_size - first - 1;   //the counts of a row by the point q at q - first - 1
+  w.times_drawn.assign(last - first, 0);
+  w.pairs_drawn.assign((std::int64_t)(last - first) * width, 0);
+  w.pairs_together.assign((std::int64_t)(last - first) * width, 0);
+
+  for (int b = 0; b < batch_size; b++) {
+    std::int64_t offset = (std::int64_t)b * points_size;
+    const int * positions = batch.drawn_positions.data() + offset;
+    const int * clusters = batch.drawn_clusters.data() + offset;
+    int size = batch.drawn_size[b];
+    for (int p = first; p < last; p++) {
+      int rank = batch.ranks[offset + p];
+      if (rank < 0)
+        continue;
+      w.times_drawn[p - first]++;
+      int * drawn = w.pairs_drawn.data() + (std::int64_t)(p - first) * width - first - 1;
+      int * together = w.pairs_together.data() + (std::int64_t)(p - first) * width - first - 1;
+      int t = rank + 1;
+      for (; t < size && clusters[t] == clusters[rank]; t++) {
+        drawn[positions[t]]++;
+        together[positions[t]]++;
+      }
+      for (; t < size; t++)
+        drawn[positions[t]]++;
+    }
+  }
+
+  for (int p = first; p < last; p++) {
+    if (w.times_drawn[p - first] == 0)
+      continue;
+    std::int64_t i = order_points[p];
+    coclustering[i * points_size + i] += w.times_drawn[p - first];
+    const int * drawn = w.pairs_drawn.data() + (std::int64_t)(p - first) * width - first - 1;
+    const int * together = w.pairs_together.data() + (std::int64_t)(p - first) * width - first - 1;
+    for (int q = p + 1; q < points_size; q++) {
+      std::int64_t j = order_points[q];
+      coclustering[i * points_size + j] += together[q];
+      coclustering[j * points_size + i] += drawn[q];
+    }
+  }
+}
+
+//the counts of count_pairs() of the sorted point p and the points after it turned into the frequencies
+static void pair_frequencies(const int * order_points, int points_size, int p, double * coclustering) {
+  const double undefined = std::numeric_limits<double>::quiet_NaN();
+  std::int64_t i = order_points[p];
+  double & times_drawn = coclustering[i * points_size + i];
+  times_drawn = times_drawn > 0 ? 1.0 : undefined;
+
+  for (int q = p + 1; q < points_size; q++) {
+    std::int64_t j = order_points[q];
+    double together = coclustering[i * points_size + j];
+    double drawn = coclustering[j * points_size + i];
+    double fraction = drawn > 0 ? together / drawn : undefined;
+    coclustering[i * points_size + j] = fraction;
+    coclustering[j * points_size + i] = fraction;
+  }
+}
+
+void bootstrap_clusters(const double * points, int points_size, int resamples, int method, int k, const std::uint32_t * seed,
+                        int threads, int queue, int * memberships, int * counts, double * coclustering) {
+
+  std::vector<int> order_points(points_size);
+  order(points, points_size, order_points.data(), threads);
+  std::vector<double> sorted_points(points_size);
+  for (int i = 0; i < points_size; i++)
+    sorted_points[i] = points[order_points[i]];
+
+  //for the co-clustering the resamples go in batches: the points drawn in the resamples of a batch are kept,
+  //and then counted into coclustering itself by blocks of rows, each block by a single worker, so no counts of the pairs
+  //are kept anywhere else, whatever the threads
+  int batch_resamples = coclustering == NULL ? resamples : std::min(resamples, std::max(threads, bootstrap_batch));
+  resample_batch batch;
+  if (coclustering != NULL) {
+    std::int64_t batch_points = (std::int64_t)batch_resamples * points_size;
+    batch.drawn_size.resize(batch_resamples);
+    batch.drawn_positions.resize(batch_points);
+    batch.drawn_clusters.resize(batch_points);
+    batch.ranks.resize(batch_points);
+    std::fill(coclustering, coclustering + (std::int64_t)points_size * points_size, 0.0);
+  }
+
+  std::vector<bootstrap_workspace> workspaces(std::max(1, threads));
+  for (int first = 0; first < resamples; first += batch_resamples) {
+    int batch_size = std::min(batch_resamples, resamples - first);
+    parallel_items(batch_size, threads, [&](int worker, int item) {
+      bootstrap_workspace & w = workspaces[worker];
+      int resample = first + item;
+      cluster_resample(order_points.data(), sorted_points.data(), points_size, resample, method, k, seed, queue, w);
+
+      std::int64_t column = (std::int64_t)resample * points_size;
+      if (memberships != NULL)
+        for (int p = 0; p < points_size; p++)
+          memberships[column + order_points[p]] = w.first_copies[p] > -1 ? w.clusters[w.first_copies[p]] : 0;
+      if (counts != NULL)
+        std::copy(w.counts.begin(), w.counts.end(), counts + column);
+      if (coclustering != NULL) {
+        std::int64_t offset = (std::int64_t)item * points_size;
+        int size = 0;
+        for (int p = 0; p < points_size; p++)
+          if (w.first_copies[p] > -1) {
+            batch.drawn_positions[offset + size] = p;
+            batch.drawn_clusters[offset + size] = w.clusters[w.first_copies[p]];
+            batch.ranks[offset + p] = size++;
+          } else
+            batch.ranks[offset + p] = -1;
+        batch.drawn_size[item] = size;
+      }
+    }, 1);
+
+    if (coclustering != NULL)
+      parallel_items((points_size + bootstrap_rows - 1) / bootstrap_rows, threads, [&](int worker, int rows) {
+        int first_row = rows * bootstrap_rows;
+        count_pairs(order_points.data(), points_size, batch, batch_size, first_row, std::min(points_size, first_row + bootstrap_rows),
+                    workspaces[worker], coclustering);
+      }, 1);
+  }
+
+  if (coclustering != NULL)
+    parallel_items(points_size, threads, [&](int worker, int p) {
+      pair_frequencies(order_points.data(), points_size, p, coclustering);
+    });
+}
@@ -0,0 +1,51 @@
+#ifndef BOOTSTRAP_H
+
+#define BOOTSTRAP_H
+#include <vector>  //std::vector
+#include <cstdint>  //std::uint32_t
+#include "workspace.h"
+
+/*
+ *                     bootstrap resamples over a single sort
+ *
+ * a resample of the points (drawn with replacement, as many as there are points) is a multiset of the points,
+ * so it is given by the counts of the sorted points: the resample in the sorted order is each sorted point repeated
+ * as many times as it is drawn, with no sorting at all. The merge loops start from it as it is (see linkage_merges_sorted()
+ * in multi.h), and its copies of a point are merged first, by the pre-pass of the duplicates (see heapbased.h and single.h),
+ * so a resample costs about as much as the points drawn at least once (about 63% of them)
+ *
+ * * bootstrap_counts() draws the counts of a resample from its own stream of std::mt19937_64 (exactly specified
+ *   by the standard), seeded by the seed given and the number of the resample, so the resamples do not depend
+ *   on the threads, nor on the order in which they are clustered
+ * * bootstrap_clusters() clusters the resamples on threads (see parallel_items() in parallel.h), each worker with
+ *   its own workspace of the merge loops, and cuts each resample into k clusters, as cutree() does: the k - 1 intervals
+ *   merged last are the breakpoints (found from the merges of the resample), and the clusters are numbered
+ *   in the sorted order, from the lowest one
+ *
+ * the results are kept by the original indices of the points, either:
+ *
+ * * memberships (points_size x resamples, by columns) - the cluster of each point in each resample (of its first copy,
+ *   which matters only for k greater than the distinct points drawn), 0 for the points not drawn,
+ *   with counts (points_size x resamples) - the counts of the points in each resample, or
+ * * coclustering (points_size x points_size) - for each pair of points, the fraction of the resamples drawing both
+ *   that put them in the same cluster (NaN for the pairs never drawn together, 1 on the diagonal of the points drawn);
+ *   the resamples are clustered in batches of bootstrap_batch (or threads, if more), and the points drawn in a batch
+ *   are counted by blocks of bootstrap_rows rows of pairs into coclustering itself, so beyond the result it takes
+ *   the points drawn in a batch and a block of rows per worker, whatever the threads
+ *
+ * methods are numbered as in hclust1d_heapbased.cpp, and 9 - single, with the queue backends of priority_queue.h
+ *
+ */
+
+const int bootstrap_seed_size = 2;
+const int bootstrap_batch = 256;
+const int bootstrap_rows = 16;
+
+//the counts of the points (by their indices) in the resample, with seed of bootstrap_seed_size values
+void bootstrap_counts(int points_size, const std::uint32_t * seed, int resample, int * counts);
+
+//any of memberships, counts and coclustering may be NULL
+void bootstrap_clusters(const double * points, int points_size, int resamples, int method, int k, const std::uint32_t * seed,
+                        int threads, int queue, int * memberships, int * counts, double * coclustering);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef CACHE_LINE_ALLOCATOR_H
+
+#define CACHE_LINE_ALLOCATOR_H
+
+#include <new>  //std::align_val_t
+#include <cstddef>  //std::size_t
+
+//an allocator placing the beginning of a vector at the beginning of a cache line
+//(used for the interval records and the 4-ary heap nodes)
+template <class T>
+struct cache_line_allocator {
+  typedef T value_type;
+  static const std::size_t cache_line = 64;
+
+  cache_line_allocator() {}
+  template <class U> cache_line_allocator(const cache_line_allocator<U> &) {}
+
+  T * allocate(std::size_t n) {
+    return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(cache_line)));
+  }
+  void deallocate(T * p, std::size_t n) { ::operator delete(p, std::align_val_t(cache_line)); }
+
+  template <class U> bool operator==(const cache_line_allocator<U> &) const { return true; }
+  template <class U> bool operator!=(const cache_line_allocator<U> &) const { return false; }
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include <vector>  //std::vector
+#include <cmath>  //std::isnan
+#include <cstddef>  //std::size_t
+#include <limits>  //std::numeric_limits
+#include <algorithm>  //std::min, std::max
+#include <stdexcept>  //std::invalid_argument
+#include "order.h"
+#include "parallel.h"
+#include "cut_index.h"
+
+void join_stages(const int * merge_left, const int * merge_right, const int * order_points, int points_size,
+                 std::vector<int> & stages) {
+  std::vector<int> rank(points_size);
+  for (int p = 0; p < points_size; p++)
+    rank[order_points[p]] = p;
+
+  //the lowest and the highest sorted position of the cluster merged at each stage
+  std::vector<int> lowest(points_size - 1), highest(points_size - 1);
+  auto positions = [&](int merge, int stage, int & low, int & high) {
+    if (merge < 0 and merge >= -points_size) {
+      low = high = rank[-merge - 1];
+      return true;
+    }
+    if (merge > 0 and merge <= stage) {
+      low = lowest[merge - 1];
+      high = highest[merge - 1];
+      return true;
+    }
+    return false;
+  };
+
+  stages.assign(points_size - 1, -1);
+  for (int stage = 0; stage < points_size - 1; stage++) {
+    int left_low, left_high, right_low, right_high;
+    if (not positions(merge_left[stage], stage, left_low, left_high) or not positions(merge_right[stage], stage, right_low, right_high))
+      throw std::invalid_argument("the merges are not of a dendrogram of the points given");
+
+    int gap;
+    if (left_high + 1 == right_low)
+      gap = left_high;
+    else if (right_high + 1 == left_low)
+      gap = right_high;
+    else
+      throw std::invalid_argument("the clusters are not contiguous in the sorted order of the points");
+    if (stages[gap] != -1)
+      throw std::invalid_argument("the merges are not of a dendrogram of the points given");
+
+    stages[gap] = stage;
+    lowest[stage] = std::min(left_low, right_low);
+    highest[stage] = std::max(left_high, right_high);
+  }
+}
+
+//the in-order walk of the complete tree lays out the sorted breakpoints (and the padding after them)
+static void lay_out(const std::vector<double> & sorted_breakpoints, const std::vector<int> & sorted_ranges,
+                    cut_level & level, std::size_t slot, std::size_t & next) {
+  if (slot >= level.breakpoints.size())
+    return;
+
+  lay_out(sorted_breakpoints, sorted_ranges, level, 2 * slot, next);
+  bool padding = next >= sorted_breakpoints.size();
+  level.breakpoints[slot] = padding ? std::numeric_limits<double>::infinity() : sorted_breakpoints[next];
+  level.ranges[slot] = sorted_ranges[padding ? sorted_breakpoints.size() : next];
+  next++;
+  lay_out(sorted_breakpoints, sorted_ranges, level, 2 * slot + 1, next);
+}
+
+void make_cut_index(const double * points, int points_size, const int * merge_left, const int * merge_right,
+                    const std::vector<int> & clusters, cut_index & index) {
+  for (int k: clusters)
+    if (k < 1 or k > points_size)
+      throw std::invalid_argument("the number of clusters must be between 1 and the number of points");
+
+  std::vector<int> order_points(points_size), rank(points_size), stages;
+  order(points, points_size, order_points.data());
+  for (int p = 0; p < points_size; p++)
+    rank[order_points[p]] = p;
+  join_stages(merge_left, merge_right, order_points.data(), points_size, stages);
+
+  std::vector<double> sorted_breakpoints;
+  std::vector<int> range_at(points_size), sorted_ranges;
+  index.levels.resize(clusters.size());
+  for (size_t l = 0; l < clusters.size(); l++) {
+    cut_level & level = index.levels[l];
+    level.clusters = clusters[l];
+
+    //the gaps joined by the last k - 1 merges, in the sorted order
+    sorted_breakpoints.clear();
+    for (int p = 0; p < points_size; p++) {
+      range_at[p] = sorted_breakpoints.size();
+      if (p < points_size - 1 and stages[p] >= points_size - level.clusters)
+        sorted_breakpoints.push_back(points[order_points[p]] / 2 + points[order_points[p + 1]] / 2);
+    }
+
+    //numbered as in cutree()
+    sorted_ranges.assign(level.clusters, 0);
+    int numbered = 0;
+    for (int i = 0; i < points_size; i++)
+      if (sorted_ranges[range_at[rank[i]]] == 0)
+        sorted_ranges[range_at[rank[i]]] = ++numbered;
+
+    level.depth = 0;
+    while (((std::size_t)1 << level.depth) - 1 < sorted_breakpoints.size())
+      level.depth++;
+    level.breakpoints.assign((std::size_t)1 << level.depth, 0.0);
+    level.ranges.assign((std::size_t)1 << level.depth, 0);
+    std::size_t next = 0;
+    lay_out(sorted_breakpoints, sorted_ranges, level, 1, next);
+    level.ranges[0] = sorted_ranges.back();
+  }
+}
+
+//the slot of the last step of a search to the left (its lowest 0 bit), or 0 if none
+static inline std::size_t left_step(std::size_t slot) {
+#if defined(__GNUC__)
+  return slot >> (__builtin_ctzll(~(unsigned long long)slot) + 1);
+#else
+  while (slot & 1)
+    slot >>= 1;
+  return slot >> 1;
+#endif
+}
+
+void assign_clusters(const cut_level & level, const double * points, int points_size, int * clusters, int missing,
+                     int threads) {
+  const double * breakpoints = level.breakpoints.data();
+  const int * ranges = level.ranges.data();
+  int depth = level.depth;
+
+  parallel_chunks(points_size, chunks_count(points_size, threads), [&](int chunk, int begin, int end) {
+    int i = begin;
+    for (; i + cut_index_lanes <= end; i += cut_index_lanes) {
+      std::size_t slot[cut_index_lanes];
+      for (int lane = 0; lane < cut_index_lanes; lane++)
+        slot[lane] = 1;
+      for (int step = 0; step < depth; step++)
+        for (int lane = 0; lane < cut_index_lanes; lane++)
+          slot[lane] = 2 * slot[lane] + (breakpoints[slot[lane]] <= points[i + lane]);
+      for (int lane = 0; lane < cut_index_lanes; lane++)
+        clusters[i + lane] = std::isnan(points[i + lane]) ? missing : ranges[left_step(slot[lane])];
+    }
+
+    for (; i < end; i++) {
+      std::size_t slot = 1;
+      for (int step = 0; step < depth; step++)
+        slot = 2 * slot + (breakpoints[slot] <= points[i]);
+      clusters[i] = std::isnan(points[i]) ? missing : ranges[left_step(slot)];
+    }
+  });
+}
@@ -0,0 +1,56 @@
+#ifndef CUT_INDEX_H
+
+#define CUT_INDEX_H
+#include <vector>  //std::vector
+
+/*
+ *                     the clusters of new points at the cuts of a dendrogram
+ *
+ * in 1D the clusters at any cut of a dendrogram are contiguous ranges of the sorted points, so a cut is given
+ * by its breakpoints: the midpoints of the gaps between the consecutive clusters, and a new point falls into
+ * the cluster of the range between the breakpoints around it (the cluster of the nearest point of the dendrogram,
+ * with a point at a midpoint going to the right)
+ *
+ * * make_cut_index() takes the stage of the merge joining each pair of consecutive sorted points (in one pass
+ *   over the merges, see join_stages()), so the breakpoints of the cut at k clusters are the gaps joined
+ *   by the last k - 1 merges, and any number of cuts comes from the same pass
+ * * the clusters are numbered as in cutree() in R: in the order of the first appearance of their points
+ * * the breakpoints of a cut are kept in the Eytzinger layout (the complete binary search tree in an array, level
+ *   by level, padded with +Inf), so the first levels of the search share a few cache lines, and a search takes
+ *   exactly depth steps of slot = 2 * slot + (breakpoint <= point), with no branch; assign_clusters() interleaves
+ *   the searches of cut_index_lanes points, so as many loads are in flight at a time
+ * * the cluster of the range ending at each breakpoint is kept at the slot of that breakpoint, and the cluster of the last
+ *   range at the slot 0 (the slot of a search never going left), so a search ends with the cluster itself
+ *
+ * throws std::invalid_argument for merges not of a dendrogram of the points given, or for clusters not contiguous
+ * in the sorted order of the points (as for a dendrogram of points other than given)
+ *
+ */
+
+const int cut_index_lanes = 8;
+
+struct cut_level {
+  int clusters;
+  int depth;
+  std::vector<double> breakpoints;   //Eytzinger, from the slot 1, padded to 2^depth - 1 breakpoints
+  std::vector<int> ranges;   //the cluster of the range ending at each breakpoint, and of the last range at the slot 0
+};
+
+struct cut_index {
+  std::vector<cut_level> levels;
+};
+
+//the stage joining the sorted points p and p + 1 at stages[p], for the merges numbered as in hclust in R,
+//and the (0-based) order of the points
+void join_stages(const int * merge_left, const int * merge_right, const int * order_points, int points_size,
+                 std::vector<int> & stages);
+
+//the cuts at the numbers of clusters given, each between 1 and points_size
+void make_cut_index(const double * points, int points_size, const int * merge_left, const int * merge_right,
+                    const std::vector<int> & clusters, cut_index & index);
+
+//the clusters of the points at a cut, and missing for the points that are NaN
+void assign_clusters(const cut_level & level, const double * points, int points_size, int * clusters, int missing,
+                     int threads = 1);
+
+#endif
@@ -1,61 +1,95 @@
 #include <Rcpp.h>
 #include <vector>
+#include <numeric>  //std::iota
+#include <string>
+#include <cmath>  //std::sqrt
+#include "dedistance.h"
+#include "dist_file.h"
 using namespace Rcpp;
 
-// [[Rcpp::export(.dedistance)]]
-NumericVector dedistance(NumericVector & distances, int points_size) {
-  //input a dist structure and return the points. Points and their direction (=sign) are arbitrarily chosen
-
-  double epsilon = 1e-10;
-
-  std::function<double(int, int)> dissimilarity = [&](int i, int j) {  //I cannot use auto scope because of recurrent call
-
-    //the dissimilarity between (row) i and j is distances[n*(i-1) - i*(i-1)/2 + j-i] in R for i<j<=n
-    //see details in https://www.rdocumentation.org/packages/stats/versions/3.6.2/topics/dist
-
-    //but if i, j and distances are 0-based
-    //and arbitrary, the following must be applied
-    if (i==j) return 0.0;
-    if (j<i) return dissimilarity(j,i);
-    return distances[points_size * i - (i+1)*i/2 + j-i - 1];
-  };
-
-  double max_dissimilarity = dissimilarity(0, 1);
-  int first = 0;
-  int second = 1;
-  for (int i = 1; i < points_size-1; i++)  //we walk through the first sub-diagonal and find two points most far apart
-    if (dissimilarity(i, i+1) > max_dissimilarity) {
-      max_dissimilarity = dissimilarity(i, i+1);
-      first = i;
-      second = i + 1;
-    }
-
-  NumericVector ret(points_size);  //a 0-valued vector of length==point_size
-  if (distances.attr("Labels") == R_NilValue) {
-    std::vector<unsigned int> indices(points_size);
+namespace {
+
+struct in_memory_dissimilarities {
+  const double * distances;
+
+  double operator()(std::int64_t index) const {
+    return distances[index];
+  }
+
+  void prefetch(std::int64_t index) const {
+  }
+};
+
+struct file_dissimilarities {
+  const dist_file & file;
+
+  double operator()(std::int64_t index) const {
+    return file(index);
+  }
+
+  void prefetch(std::int64_t index) const {
+    file.prefetch(index);
+  }
+};
+
+//squared dissimilarities get sqrt-ed lazily, only those actually read by dedistance (about 3n of them),
+//hclust1d has no need for squared distances
+template <class dissimilarities>
+struct square_rooted_dissimilarities {
+  const dissimilarities & squared;
+
+  double operator()(std::int64_t index) const {
+    double entry = squared(index);
+    if (entry < 0)
+      stop("A negative value found in a squared distance matrix");
+    return std::sqrt(entry);
+  }
+
+  void prefetch(std::int64_t index) const {
+    squared.prefetch(index);
+  }
+};
+
+template <class dissimilarities>
+void lazy_dedistance(const dissimilarities & d, bool squared, int points_size, double * points) {
+  if (squared)
+    dedistance(square_rooted_dissimilarities<dissimilarities>{d}, points_size, points);
+  else
+    dedistance(d, points_size, points);
+}
+
+void set_names(NumericVector & points, RObject labels) {
+  if (labels == R_NilValue) {
+    std::vector<unsigned int> indices(points.size());
     std::iota(indices.begin(), indices.end(), 1);
-    ret.names() = indices;
+    points.names() = indices;
   }
   else
-    ret.names() = distances.attr("Labels");
+    points.names() = labels;
+}
+
+}
 
+// [[Rcpp::export(.dedistance)]]
+NumericVector dedistance(NumericVector & distances, int points_size, bool squared = false) {
+  //input a dist structure (possibly squared) and return the points. Points and their direction (=sign) are arbitrarily chosen
 
-  if (max_dissimilarity < epsilon)
-    return ret;
+  NumericVector ret(points_size);
+  lazy_dedistance(in_memory_dissimilarities{distances.begin()}, squared, points_size, ret.begin());
+  set_names(ret, distances.attr("Labels"));
 
-  // we assume second > first, the distance == max_dissimilarity > 0
+  return ret;
+}
 
-  for (int i=0; i<points_size; i++) {
-    double dis1 = dissimilarity(i, first);
-    double dis2 = dissimilarity(i, second);
-    if (dis1 + dis2 > max_dissimilarity + epsilon) //i is outside of (first, second) interval
-      if (dis1 < dis2)  // i < first
-        ret[i] = - dis1;
-      else     //i > second
-        ret[i] = dis1;
-    else    //i is inside (first, second) interval
-      ret[i] = dis1;
-  }
+// [[Rcpp::export(.dedistance_file)]]
+NumericVector dedistance_file(std::string path, int points_size, bool squared, RObject labels) {
+  //the same, but for a dist structure in a binary file, of which only the needed entries are ever read
+
+  dist_file file(path, points_size);
+
+  NumericVector ret(points_size);
+  lazy_dedistance(file_dissimilarities{file}, squared, points_size, ret.begin());
+  set_names(ret, labels);
 
   return ret;
 }
@@ -0,0 +1,88 @@
+#ifndef DEDISTANCE_H
+
+#define DEDISTANCE_H
+
+#include <cstdint>  //std::int64_t
+
+/*
+ *                     points from a distance structure
+ *
+ * the distance structure is an R dist packed lower triangle of n*(n-1)/2 entries, accessed through
+ * a dissimilarities struct with two functions:
+ *
+ * * d(index) - the entry at a packed index
+ * * d.prefetch(index) - a hint that the entry is going to be read soon (it can do nothing)
+ *
+ * only the first sub-diagonal and two columns of the structure are read, so the struct can be backed
+ * by anything, not necessarily by a vector in memory
+ *
+ */
+
+//the dissimilarity between (row) i and j is distances[n*(i-1) - i*(i-1)/2 + j-i] in R for i<j<=n
+//see details in https://www.rdocumentation.org/packages/stats/versions/3.6.2/topics/dist
+//below i and j are 0-based and i<j
+inline std::int64_t dist_index(int i, int j, int points_size) {
+  return (std::int64_t)points_size * i - (std::int64_t)(i + 1) * i / 2 + j - i - 1;
+}
+
+template <class dissimilarities>
+inline double dissimilarity(const dissimilarities & d, int i, int j, int points_size) {
+  if (i == j)
+    return 0.0;
+  return i < j ? d(dist_index(i, j, points_size)) : d(dist_index(j, i, points_size));
+}
+
+template <class dissimilarities>
+inline void prefetch_dissimilarity(const dissimilarities & d, int i, int j, int points_size) {
+  if (i != j)
+    d.prefetch(i < j ? dist_index(i, j, points_size) : dist_index(j, i, points_size));
+}
+
+//input a dist structure and output the points. Points and their direction (=sign) are arbitrarily chosen
+template <class dissimilarities>
+void dedistance(const dissimilarities & d, int points_size, double * points) {
+
+  double epsilon = 1e-10;
+
+  for (int i = 0; i < points_size; i++)
+    points[i] = 0.0;
+
+  for (int i = 0; i < points_size-1; i++)
+    prefetch_dissimilarity(d, i, i+1, points_size);
+
+  double max_dissimilarity = dissimilarity(d, 0, 1, points_size);
+  int first = 0;
+  int second = 1;
+  for (int i = 1; i < points_size-1; i++) {  //we walk through the first sub-diagonal and find two points most far apart
+    double sub_diagonal = dissimilarity(d, i, i+1, points_size);
+    if (sub_diagonal > max_dissimilarity) {
+      max_dissimilarity = sub_diagonal;
+      first = i;
+      second = i + 1;
+    }
+  }
+
+  if (max_dissimilarity < epsilon)
+    return;
+
+  // we assume second > first, the distance == max_dissimilarity > 0
+
+  for (int i = 0; i < points_size; i++) {
+    prefetch_dissimilarity(d, i, first, points_size);
+    prefetch_dissimilarity(d, i, second, points_size);
+  }
+
+  for (int i=0; i<points_size; i++) {
+    double dis1 = dissimilarity(d, i, first, points_size);
+    double dis2 = dissimilarity(d, i, second, points_size);
+    if (dis1 + dis2 > max_dissimilarity + epsilon) //i is outside of (first, second) interval
+      if (dis1 < dis2)  // i < first
+        points[i] = - dis1;
+      else     //i > second
+        points[i] = dis1;
+    else    //i is inside (first, second) interval
+      points[i] = dis1;
+  }
+}
+
+#endif
@@ -0,0 +1,176 @@
+#include <cstdio>  //std::FILE, std::fread, std::fwrite, std::remove, std::rename
+#include <cstring>  //std::memset, std::memcpy, std::memcmp, std::strncpy
+#include <cstdint>  //std::int64_t
+#include <string>  //std::string
+#include "external_sort.h"
+#include "dendrogram_file.h"
+#ifndef _WIN32
+#include <sys/mman.h>  //mmap, munmap
+#include <sys/stat.h>  //fstat
+#include <fcntl.h>  //open
+#include <unistd.h>  //close, ftruncate
+#endif
+
+static std::string partial(const std::string & path) {
+  return path + ".partial";
+}
+
+static std::int64_t aligned(std::int64_t offset) {
+  return (offset + 7) & ~(std::int64_t)7;
+}
+
+//the offsets of the blocks, by the number of points and the labels only
+static dendrogram_file_header layout(std::int64_t points_size, int labels, std::int64_t labels_bytes) {
+  dendrogram_file_header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, dendrogram_file_magic, sizeof(header.magic));
+  header.version = dendrogram_file_version;
+  header.byte_order = dendrogram_file_byte_order;
+  header.points_size = points_size;
+  header.labels = labels;
+  header.merge_offset = aligned(sizeof(dendrogram_file_header));
+  header.height_offset = aligned(header.merge_offset + 2 * (points_size - 1) * (std::int64_t)sizeof(int));
+  header.order_offset = header.height_offset + (points_size - 1) * (std::int64_t)sizeof(double);
+  header.labels_offset = aligned(header.order_offset + points_size * (std::int64_t)sizeof(int));
+  header.file_size = header.labels_offset;
+  if (labels == string_dendrogram_labels)
+    header.file_size += (points_size + 1) * (std::int64_t)sizeof(std::int64_t) + labels_bytes;
+  else if (labels == value_dendrogram_labels)
+    header.file_size += points_size * (std::int64_t)sizeof(double);
+  return header;
+}
+
+dendrogram_file::dendrogram_file(const std::string & path)
+  : path(path), data(NULL), writing(false) {
+  map(false);
+
+  dendrogram_file_header & h = *(dendrogram_file_header *) data;
+  bool conforming = std::memcmp(h.magic, dendrogram_file_magic, sizeof(h.magic)) == 0 and h.byte_order == dendrogram_file_byte_order
+    and h.version == dendrogram_file_version and h.points_size >= 2 and h.points_size <= INT32_MAX and h.labels >= no_dendrogram_labels and h.labels <= value_dendrogram_labels;
+  if (conforming) {
+    std::int64_t labels_bytes = h.file_size - h.labels_offset - (h.points_size + 1) * (std::int64_t)sizeof(std::int64_t);
+    dendrogram_file_header expected = layout(h.points_size, (int)h.labels, labels_bytes);
+    conforming = h.merge_offset == expected.merge_offset and h.height_offset == expected.height_offset
+      and h.order_offset == expected.order_offset and h.labels_offset == expected.labels_offset
+      and h.file_size == expected.file_size and h.file_size == header.file_size and (h.labels != string_dendrogram_labels or labels_bytes >= 0);
+  }
+  if (not conforming) {
+    unmap();
+    throw file_error("the file " + path + " is not a dendrogram of hclust1d (or of a version not supported)");
+  }
+
+  header = h;
+  header.method[sizeof(header.method) - 1] = '\0';
+  header.dist_method[sizeof(header.dist_method) - 1] = '\0';
+}
+
+dendrogram_file::dendrogram_file(const std::string & path, std::int64_t points_size, int labels, std::int64_t labels_bytes)
+  : path(path), header(layout(points_size, labels, labels_bytes)), data(NULL), writing(true) {
+  map(true);
+}
+
+dendrogram_file::~dendrogram_file() {
+  unmap();
+  if (writing)
+    std::remove(partial(path).c_str());
+}
+
+bool dendrogram_file::label(std::int64_t i, const char *& bytes, std::int64_t & length) {
+  const std::int64_t * offsets = label_offsets();
+  std::int64_t labels_bytes = header.file_size - header.labels_offset - (header.points_size + 1) * (std::int64_t)sizeof(std::int64_t);
+  if (offsets[i] < 0 or offsets[i] > offsets[i + 1] or offsets[i + 1] > labels_bytes)
+    return false;
+  bytes = label_bytes() + offsets[i];
+  length = offsets[i + 1] - offsets[i];
+  return true;
+}
+
+void dendrogram_file::finish(const std::string & method, const std::string & dist_method) {
+  std::strncpy(header.method, method.c_str(), sizeof(header.method) - 1);
+  std::strncpy(header.dist_method, dist_method.c_str(), sizeof(header.dist_method) - 1);
+  std::memcpy(data, &header, sizeof(header));
+
+#ifdef _WIN32
+  std::FILE * file = open_file(partial(path), "wb");
+  if (std::fwrite(data, 1, header.file_size, file) != (size_t)header.file_size) {
+    std::fclose(file);
+    throw file_error("cannot write the file " + path);
+  }
+  close_file(file, partial(path));
+  std::remove(path.c_str());   //rename() does not replace a file on Windows
+#endif
+
+  if (std::rename(partial(path).c_str(), path.c_str()) != 0)
+    throw file_error("cannot write the file " + path);
+  writing = false;
+}
+
+#ifdef _WIN32
+
+void dendrogram_file::map(bool create) {
+  if (create) {
+    std::FILE * file = open_file(partial(path), "wb");   //fails early, as with mmap
+    std::fclose(file);
+    buffer.assign(header.file_size, 0);
+    data = buffer.data();
+    return;
+  }
+
+  std::FILE * file = open_file(path, "rb");
+  if (_fseeki64(file, 0, SEEK_END) != 0 or (header.file_size = _ftelli64(file)) < (std::int64_t)sizeof(dendrogram_file_header)) {
+    std::fclose(file);
+    throw file_error("the file " + path + " is not a dendrogram of hclust1d (or of a version not supported)");
+  }
+  buffer.resize(header.file_size);
+  bool read = _fseeki64(file, 0, SEEK_SET) == 0 and std::fread(buffer.data(), 1, header.file_size, file) == (size_t)header.file_size;
+  std::fclose(file);
+  if (not read)
+    throw file_error("cannot read the file " + path);
+  data = buffer.data();
+}
+
+void dendrogram_file::unmap() {
+  std::vector<char>().swap(buffer);
+  data = NULL;
+}
+
+#else
+
+void dendrogram_file::map(bool create) {
+  int descriptor = create ? open(partial(path).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666) : open(path.c_str(), O_RDONLY);
+  if (descriptor < 0)
+    throw file_error("cannot open the file " + (create ? partial(path) : path));
+
+  if (create) {
+    if (ftruncate(descriptor, header.file_size) != 0) {
+      close(descriptor);
+      std::remove(partial(path).c_str());
+      throw file_error("cannot write the file " + path);
+    }
+  } else {
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 or (std::int64_t)status.st_size < (std::int64_t)sizeof(dendrogram_file_header)) {
+      close(descriptor);
+      throw file_error("the file " + path + " is not a dendrogram of hclust1d (or of a version not supported)");
+    }
+    header.file_size = status.st_size;
+  }
+
+  //a private mapping of a file read is writable with copies on write, so R may change the vectors over it
+  void * mapping = mmap(NULL, header.file_size, PROT_READ | PROT_WRITE, create ? MAP_SHARED : MAP_PRIVATE, descriptor, 0);
+  close(descriptor);   //the mapping keeps the file
+  if (mapping == MAP_FAILED) {
+    if (create)
+      std::remove(partial(path).c_str());
+    throw file_error("cannot map the file " + path);
+  }
+  data = (char *) mapping;
+}
+
+void dendrogram_file::unmap() {
+  if (data != NULL)
+    munmap(data, header.file_size);
+  data = NULL;
+}
+
+#endif
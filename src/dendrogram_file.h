@@ -0,0 +1,98 @@
+#ifndef DENDROGRAM_FILE_H
+
+#define DENDROGRAM_FILE_H
+#include <cstdint>  //std::int64_t, std::uint32_t
+#include <string>  //std::string
+#include <vector>  //std::vector
+
+/*
+ *                     the binary file of a dendrogram
+ *
+ * a columnar file of native layout, so that reopening a dendrogram maps it and reads nothing up front:
+ * the arrays are used in place, paging in lazily (see hclust1d_save.cpp for the ALTREP vectors over them in R)
+ *
+ * * the header (dendrogram_file_header), with the offsets of the blocks following, each aligned at 8 bytes
+ * * merge - 2 * (points_size - 1) ints, merge[, 1] followed by merge[, 2], numbered as in hclust in R
+ *   (so the block is the IntegerMatrix of R as it is)
+ * * height - points_size - 1 doubles
+ * * order - points_size ints, the (1-based) order of the points, as in hclust in R
+ * * labels (optional) - either the strings (points_size + 1 offsets of int64 into the UTF-8 bytes following them),
+ *   or the values of the points (points_size doubles, by the indices of the points), formatted only when read
+ *   (see labels.h)
+ *
+ * a dendrogram_file is either opened for reading (the whole file mapped privately, so writing to the arrays
+ * changes the memory only, never the file), or created for writing with its final size: the file is mapped
+ * and the merge loops write the merges, the heights and the order straight to it, with no copies (see multi.h).
+ * A file created is written under a temporary name (the path with ".partial" appended) and renamed to its path
+ * by finish(), after its header: so a file left unfinished by an error is never taken for a dendrogram (the destructor
+ * removes it), and a dendrogram mapped from the path stays intact while a new one is written over it
+ *
+ * without mmap (on Windows) the file is read into memory, or written from memory by finish()
+ *
+ * any failure of the file system, and a file not of this format, is thrown as a file_error (see external_sort.h)
+ *
+ */
+
+const char dendrogram_file_magic[8] = {'H', 'C', 'L', '1', 'D', 'D', 'G', '\0'};
+const std::uint32_t dendrogram_file_version = 1;
+const std::uint32_t dendrogram_file_byte_order = 0x01020304;   //reads differently on the other byte order
+
+enum dendrogram_labels {
+  no_dendrogram_labels = 0,
+  string_dendrogram_labels = 1,
+  value_dendrogram_labels = 2
+};
+
+struct dendrogram_file_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::int64_t points_size;
+  std::int64_t labels;   //one of dendrogram_labels
+  std::int64_t merge_offset;
+  std::int64_t height_offset;
+  std::int64_t order_offset;
+  std::int64_t labels_offset;
+  std::int64_t file_size;
+  char method[32];   //NUL-terminated
+  char dist_method[16];
+};
+
+struct dendrogram_file {
+  //opens a file for reading
+  explicit dendrogram_file(const std::string & path);
+  //creates a file for writing, labels_bytes is the length of all the string labels (for string_dendrogram_labels only)
+  dendrogram_file(const std::string & path, std::int64_t points_size, int labels, std::int64_t labels_bytes = 0);
+  ~dendrogram_file();
+  dendrogram_file(const dendrogram_file &) = delete;
+  dendrogram_file & operator=(const dendrogram_file &) = delete;
+
+  //writes the header, with the method names given (truncated to fit), and renames the file to its path; for files created only
+  void finish(const std::string & method, const std::string & dist_method);
+
+  std::int64_t points_size() const { return header.points_size; }
+  int labels() const { return (int)header.labels; }
+
+  int * merge_left() { return (int *)(data + header.merge_offset); }
+  int * merge_right() { return merge_left() + header.points_size - 1; }
+  double * height() { return (double *)(data + header.height_offset); }
+  int * order() { return (int *)(data + header.order_offset); }
+  std::int64_t * label_offsets() { return (std::int64_t *)(data + header.labels_offset); }
+  char * label_bytes() { return (char *)(label_offsets() + header.points_size + 1); }
+  double * label_values() { return (double *)(data + header.labels_offset); }
+  //the string label i, checked against the bounds of the block (the offsets are not checked when the file is opened)
+  bool label(std::int64_t i, const char *& bytes, std::int64_t & length);
+
+  std::string path;   //being written under path + ".partial"
+  dendrogram_file_header header;
+  char * data;   //the whole file
+  bool writing;   //created and not finished yet
+
+private:
+  void map(bool create);
+  void unmap();
+
+  std::vector<char> buffer;   //without mmap
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include <Rcpp.h>
+#include <string>
+#include "dist_file.h"
+#ifndef _WIN32
+#include <sys/mman.h>  //mmap, madvise
+#include <sys/stat.h>  //fstat
+#include <fcntl.h>  //open
+#include <unistd.h>  //close, sysconf
+#endif
+using namespace Rcpp;
+
+#ifdef _WIN32
+
+dist_file::dist_file(const std::string & path, int points_size) {
+  size = (std::int64_t)points_size * (points_size - 1) / 2;
+
+  file = std::fopen(path.c_str(), "rb");
+  if (file == NULL)
+    stop("cannot open the distance file " + path);
+
+  if (_fseeki64(file, 0, SEEK_END) != 0 or _ftelli64(file) != size * (std::int64_t)sizeof(double)) {
+    std::fclose(file);
+    stop("nonconforming size of the distance file " + path);
+  }
+}
+
+dist_file::~dist_file() {
+  std::fclose(file);
+}
+
+double dist_file::operator()(std::int64_t index) const {
+  double entry = 0.0;
+  if (_fseeki64(file, index * (std::int64_t)sizeof(double), SEEK_SET) != 0 or std::fread(&entry, sizeof(double), 1, file) != 1)
+    stop("cannot read the distance file");
+  return entry;
+}
+
+void dist_file::prefetch(std::int64_t index) const {
+}
+
+#else
+
+dist_file::dist_file(const std::string & path, int points_size) {
+  size = (std::int64_t)points_size * (points_size - 1) / 2;
+  page_size = sysconf(_SC_PAGESIZE);
+  last_prefetched_page = -1;
+
+  descriptor = open(path.c_str(), O_RDONLY);
+  if (descriptor < 0)
+    stop("cannot open the distance file " + path);
+
+  struct stat status;
+  if (fstat(descriptor, &status) != 0 or (std::int64_t)status.st_size != size * (std::int64_t)sizeof(double)) {
+    close(descriptor);
+    stop("nonconforming size of the distance file " + path);
+  }
+
+  void * mapping = mmap(NULL, size * sizeof(double), PROT_READ, MAP_SHARED, descriptor, 0);
+  if (mapping == MAP_FAILED) {
+    close(descriptor);
+    stop("cannot map the distance file " + path);
+  }
+  //only O(n) entries scattered over the file are read, readahead would load pages in vain
+  madvise(mapping, size * sizeof(double), MADV_RANDOM);
+  entries = (const double *) mapping;
+}
+
+dist_file::~dist_file() {
+  munmap((void *) entries, size * sizeof(double));
+  close(descriptor);
+}
+
+double dist_file::operator()(std::int64_t index) const {
+  return entries[index];
+}
+
+void dist_file::prefetch(std::int64_t index) const {
+  std::int64_t page = index * (std::int64_t)sizeof(double) / page_size;
+  if (page == last_prefetched_page)
+    return;
+  last_prefetched_page = page;
+  madvise((void *) ((const char *) entries + page * page_size), page_size, MADV_WILLNEED);
+}
+
+#endif
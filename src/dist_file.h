@@ -0,0 +1,44 @@
+#ifndef DIST_FILE_H
+
+#define DIST_FILE_H
+
+#include <string>  //std::string
+#include <cstdint>  //std::int64_t
+#include <cstdio>  //std::FILE
+
+/*
+ *                     a distance structure in a binary file
+ *
+ * the file holds the entries of an R dist packed lower triangle as native doubles
+ * (as written by writeBin(as.vector(d), file)), and is read lazily, an entry at a time
+ *
+ * * on POSIX systems the file is memory-mapped with random access advice,
+ *   and prefetch() asks the kernel to read the page of an entry ahead
+ * * elsewhere, the entries are read with a seek and a read each, and prefetch() does nothing
+ *
+ * the whole file is never loaded, only the pages holding the entries actually read
+ *
+ */
+
+struct dist_file {
+  dist_file(const std::string & path, int points_size);
+  ~dist_file();
+  dist_file(const dist_file &) = delete;
+  dist_file & operator=(const dist_file &) = delete;
+
+  double operator()(std::int64_t index) const;
+  void prefetch(std::int64_t index) const;
+
+  std::int64_t size;   //the number of entries
+
+#ifdef _WIN32
+  std::FILE * file;
+#else
+  int descriptor;
+  const double * entries;
+  std::int64_t page_size;
+  mutable std::int64_t last_prefetched_page;
+#endif
+};
+
+#endif
@@ -0,0 +1,37 @@
+#include <cstdio>  //std::fopen, std::fclose, std::remove
+#include <atomic>  //std::atomic
+#include <string>  //std::string, std::to_string
+#include "external_sort.h"
+#ifdef _WIN32
+#include <process.h>  //_getpid
+#else
+#include <unistd.h>  //getpid
+#endif
+
+//the names are unique within a process by a counter, and across processes by the process id
+static std::atomic<unsigned long> temporary_files(0);
+
+temporary_file::temporary_file(const std::string & directory) {
+#ifdef _WIN32
+  long process = _getpid();
+#else
+  long process = getpid();
+#endif
+  path = directory + "/hclust1d_" + std::to_string(process) + "_" + std::to_string(temporary_files++) + ".tmp";
+}
+
+temporary_file::~temporary_file() {
+  std::remove(path.c_str());   //it may have never been created
+}
+
+std::FILE * open_file(const std::string & path, const char * mode) {
+  std::FILE * file = std::fopen(path.c_str(), mode);
+  if (file == NULL)
+    throw file_error("cannot open the file " + path);
+  return file;
+}
+
+void close_file(std::FILE * file, const std::string & path) {
+  if (std::fclose(file) != 0)
+    throw file_error("cannot write the file " + path);
+}
@@ -0,0 +1,282 @@
+#ifndef EXTERNAL_SORT_H
+
+#define EXTERNAL_SORT_H
+
+#include <cstdio>  //std::FILE, std::fread, std::fwrite
+#include <cstdint>  //std::int64_t
+#include <string>  //std::string
+#include <vector>  //std::vector
+#include <memory>  //std::unique_ptr
+#include <utility>  //std::pair, std::make_pair
+#include <algorithm>  //std::sort, std::push_heap, std::pop_heap, std::max, std::min
+#include <stdexcept>  //std::runtime_error
+
+/*
+ *                     external sorting of records in temporary files
+ *
+ * for data larger than memory (see single_file.h): the records are plain structs, written and read
+ * sequentially only, through buffers of record_buffer_bytes, in binary files of native layout
+ *
+ * * external_sorter collects the records added up to its memory budget, then sorts them and spills them
+ *   as a run to a temporary file; finish() merges the runs, external_sort_fan_in at a time (in more passes
+ *   if there are more runs), and hands the records over to a consumer in the sorted order, so the last pass
+ *   writes no file at all, and the records fitting the budget get sorted in memory with no file at all
+ * * spill_stack is a stack with its top in memory, spilling its bottom to temporary files in blocks
+ * * temporary files are created in a given directory and removed as soon as they are read,
+ *   or by their destructors (also on errors)
+ *
+ * the comparisons of the records must be total orders, so that the result does not depend on the runs
+ * any failure of the file system is thrown as a file_error
+ *
+ */
+
+const std::int64_t record_buffer_bytes = 1 << 20;
+const size_t external_sort_fan_in = 64;
+
+struct file_error : std::runtime_error {
+  explicit file_error(const std::string & what) : std::runtime_error(what) {}
+};
+
+//a file of a unique name in a directory, removed by the destructor
+struct temporary_file {
+  explicit temporary_file(const std::string & directory);
+  ~temporary_file();
+  temporary_file(const temporary_file &) = delete;
+  temporary_file & operator=(const temporary_file &) = delete;
+
+  std::string path;
+};
+
+//both throw a file_error on failure, close_file() also on a failure of writing the buffered data
+std::FILE * open_file(const std::string & path, const char * mode);
+void close_file(std::FILE * file, const std::string & path);
+
+template <class record>
+size_t buffer_records(std::int64_t bytes) {
+  return (size_t) std::max<std::int64_t>(1, bytes / (std::int64_t)sizeof(record));
+}
+
+template <class record>
+struct record_writer {
+  record_writer(const std::string & path, size_t buffer_size = buffer_records<record>(record_buffer_bytes))
+    : path(path), file(open_file(path, "wb")), buffer(buffer_size), used(0) {}
+  ~record_writer() {
+    if (file != NULL)
+      std::fclose(file);
+  }
+  record_writer(const record_writer &) = delete;
+  record_writer & operator=(const record_writer &) = delete;
+
+  void write(const record & r) {
+    buffer[used++] = r;
+    if (used == buffer.size())
+      flush();
+  }
+
+  void flush() {
+    if (used > 0 and std::fwrite(buffer.data(), sizeof(record), used, file) != used)
+      throw file_error("cannot write the file " + path);
+    used = 0;
+  }
+
+  void close() {
+    flush();
+    std::FILE * closed = file;
+    file = NULL;
+    close_file(closed, path);
+  }
+
+  std::string path;
+  std::FILE * file;
+  std::vector<record> buffer;
+  size_t used;
+};
+
+template <class record>
+struct record_reader {
+  record_reader(const std::string & path, size_t buffer_size = buffer_records<record>(record_buffer_bytes))
+    : path(path), file(open_file(path, "rb")), buffer(buffer_size), filled(0), next(0) {}
+  ~record_reader() {
+    std::fclose(file);
+  }
+  record_reader(const record_reader &) = delete;
+  record_reader & operator=(const record_reader &) = delete;
+
+  //false at the end of the file
+  bool read(record & r) {
+    if (next == filled) {
+      //read by bytes, to tell a trailing partial record from the end of the file
+      size_t bytes = std::fread(buffer.data(), 1, buffer.size() * sizeof(record), file);
+      if (std::ferror(file))
+        throw file_error("cannot read the file " + path);
+      if (bytes % sizeof(record) != 0)
+        throw file_error("the size of the file " + path + " is not a multiple of its record size");
+      filled = bytes / sizeof(record);
+      next = 0;
+      if (filled == 0)
+        return false;
+    }
+    r = buffer[next++];
+    return true;
+  }
+
+  std::string path;
+  std::FILE * file;
+  std::vector<record> buffer;
+  size_t filled;
+  size_t next;
+};
+
+template <class record, class compare>
+struct external_sorter {
+  //memory: the bytes of the records held in memory, either collected or buffered for merging
+  external_sorter(std::int64_t memory, const std::string & directory, compare less = compare())
+    : less(less), directory(directory), budget(buffer_records<record>(memory)) {}
+
+  void add(const record & r) {
+    collected.push_back(r);
+    if (collected.size() == budget)
+      spill();
+  }
+
+  //consume(r) is called for all the records added, in the sorted order
+  template <class consumer>
+  void finish(consumer consume) {
+    if (runs.empty()) {
+      std::sort(collected.begin(), collected.end(), less);
+      for (const record & r: collected)
+        consume(r);
+      std::vector<record>().swap(collected);
+      return;
+    }
+
+    if (not collected.empty())
+      spill();
+    std::vector<record>().swap(collected);   //the memory goes to the buffers of the merge
+
+    while (runs.size() > external_sort_fan_in) {
+      std::vector<std::unique_ptr<temporary_file> > merged_runs;
+      for (size_t first = 0; first < runs.size(); first += external_sort_fan_in) {
+        size_t last = std::min(runs.size(), first + external_sort_fan_in);
+        merged_runs.emplace_back(new temporary_file(directory));
+        record_writer<record> writer(merged_runs.back()->path, budget / (external_sort_fan_in + 1) + 1);
+        merge(first, last, [&](const record & r) { writer.write(r); });
+        writer.close();
+      }
+      runs.swap(merged_runs);
+    }
+
+    merge(0, runs.size(), consume);
+    runs.clear();
+  }
+
+  //the runs from first to last - 1 merged, and removed
+  template <class consumer>
+  void merge(size_t first, size_t last, consumer consume) {
+    std::vector<std::unique_ptr<record_reader<record> > > readers;
+    for (size_t run = first; run < last; run++)
+      readers.emplace_back(new record_reader<record>(runs[run]->path, budget / (external_sort_fan_in + 1) + 1));
+
+    //the next record of each run, with the least one at the front, ties resolved by the run
+    std::vector<std::pair<record, size_t> > heads;
+    auto follows = [&](const std::pair<record, size_t> & a, const std::pair<record, size_t> & b) {
+      return less(b.first, a.first) or (not less(a.first, b.first) and b.second < a.second);
+    };
+    record r;
+    for (size_t reader = 0; reader < readers.size(); reader++)
+      if (readers[reader]->read(r))
+        heads.push_back(std::make_pair(r, reader));
+    std::make_heap(heads.begin(), heads.end(), follows);
+
+    while (not heads.empty()) {
+      std::pop_heap(heads.begin(), heads.end(), follows);
+      consume(heads.back().first);
+      size_t reader = heads.back().second;
+      if (readers[reader]->read(heads.back().first))
+        std::push_heap(heads.begin(), heads.end(), follows);
+      else
+        heads.pop_back();
+    }
+
+    readers.clear();
+    for (size_t run = first; run < last; run++)
+      runs[run].reset();
+  }
+
+  void spill() {
+    std::sort(collected.begin(), collected.end(), less);
+    runs.emplace_back(new temporary_file(directory));
+    std::FILE * file = open_file(runs.back()->path, "wb");
+    if (std::fwrite(collected.data(), sizeof(record), collected.size(), file) != collected.size()) {
+      std::fclose(file);
+      throw file_error("cannot write the file " + runs.back()->path);
+    }
+    close_file(file, runs.back()->path);
+    collected.clear();
+  }
+
+  compare less;
+  std::string directory;
+  size_t budget;   //records
+  std::vector<record> collected;
+  std::vector<std::unique_ptr<temporary_file> > runs;
+};
+
+template <class record>
+struct spill_stack {
+  //memory: the bytes of the top kept in memory
+  spill_stack(std::int64_t memory, const std::string & directory)
+    : directory(directory), capacity(std::max<size_t>(2, buffer_records<record>(memory))) {}
+
+  bool empty() const { return top.empty() and spilled.empty(); }
+
+  void push(const record & r) {
+    if (top.size() == capacity)
+      spill();
+    top.push_back(r);
+  }
+
+  record & back() {
+    if (top.empty())
+      reload();
+    return top.back();
+  }
+
+  void pop() {
+    if (top.empty())
+      reload();
+    top.pop_back();
+  }
+
+  //the bottom half of the top goes to a file, on top of the ones spilled before
+  void spill() {
+    size_t half = capacity / 2;
+    spilled.emplace_back(new temporary_file(directory));
+    std::FILE * file = open_file(spilled.back()->path, "wb");
+    if (std::fwrite(top.data(), sizeof(record), half, file) != half) {
+      std::fclose(file);
+      throw file_error("cannot write the file " + spilled.back()->path);
+    }
+    close_file(file, spilled.back()->path);
+    top.erase(top.begin(), top.begin() + half);
+  }
+
+  void reload() {
+    size_t half = capacity / 2;
+    top.resize(half);
+    std::FILE * file = open_file(spilled.back()->path, "rb");
+    if (std::fread(top.data(), sizeof(record), half, file) != half) {
+      std::fclose(file);
+      throw file_error("cannot read the file " + spilled.back()->path);
+    }
+    std::fclose(file);
+    spilled.pop_back();
+  }
+
+  std::string directory;
+  size_t capacity;   //records
+  std::vector<record> top;
+  std::vector<std::unique_ptr<temporary_file> > spilled;   //blocks of capacity / 2 records, the last one is the highest
+};
+
+#endif
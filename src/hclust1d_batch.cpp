@@ -0,0 +1,152 @@
+#include <Rcpp.h>
+#include <vector>  //std::vector
+#include "heapbased.h"
+#include "single.h"
+#include "parallel.h"
+#include "labels.h"
+
+using namespace Rcpp;
+
+// many independent clusterings in one call: the groups are clustered in parallel, by the merge loops on raw arrays
+// (see heapbased.h and single.h), each worker thread reusing its own workspace from one group to the next
+//
+// all the R objects are allocated before and completed after the parallel part, which touches raw arrays only
+
+struct batch_group {
+  const double * points;
+  int points_size;
+  int * order_points;
+  int * merge_left;
+  int * merge_right;
+  double * height;
+};
+
+template <class workspace, class merges>
+void batch_merges(std::vector<batch_group> & groups, int threads, merges group_merges) {
+  std::vector<workspace> workspaces(threads);
+  parallel_items(groups.size(), threads, [&](int worker, int item) {
+    batch_group & g = groups[item];
+    group_merges(g, workspaces[worker]);
+    for (int i = 0; i < g.points_size; i++)
+      g.order_points[i]++;    //make it R conformant
+  });
+}
+
+template <class linkage, class queue>
+void batch_heapbased(std::vector<batch_group> & groups, int threads) {
+  batch_merges<heapbased_workspace<linkage, queue> >(groups, threads, [](batch_group & g, heapbased_workspace<linkage, queue> & w) {
+    dendrogram_sink merges = {g.merge_left, g.merge_right, g.height};
+    heapbased_merges(g.points, g.points_size, w, g.order_points, merges);
+  });
+}
+
+template <class linkage>
+void batch_heapbased(std::vector<batch_group> & groups, int threads, int queue) {
+  switch (queue) {
+  case binary_heap_backend:
+    return batch_heapbased<linkage, struct heap>(groups, threads);
+  case quaternary_heap_backend:
+    return batch_heapbased<linkage, struct quaternary_heap>(groups, threads);
+  case tournament_tree_backend:
+    return batch_heapbased<linkage, struct tournament_tree>(groups, threads);
+  }
+
+  stop("unsupported priority queue backend");
+}
+
+void batch_single(std::vector<batch_group> & groups, int threads) {
+  batch_merges<struct single_workspace>(groups, threads, [](batch_group & g, struct single_workspace & w) {
+    single_merges(g.points, g.points_size, 1, w, g.order_points, g.merge_left, g.merge_right, g.height);
+  });
+}
+
+void batch(std::vector<batch_group> & groups, int method, int threads, int queue) {
+  // methods as in hclust1d_heapbased.cpp, and 9 - single
+  switch (method) {
+  case 0:
+    return batch_heapbased<single_linkage>(groups, threads, queue);
+  case 1:
+    return batch_heapbased<complete_linkage>(groups, threads, queue);
+  case 2:
+    return batch_heapbased<average_linkage>(groups, threads, queue);
+  case 3:
+    return batch_heapbased<centroid_linkage>(groups, threads, queue);
+  case 4:
+    return batch_heapbased<true_median_linkage>(groups, threads, queue);
+  case 5:
+    return batch_heapbased<median_linkage>(groups, threads, queue);
+  case 6:
+    return batch_heapbased<mcquitty_linkage>(groups, threads, queue);
+  case 7:
+    return batch_heapbased<ward_D_linkage>(groups, threads, queue);
+  case 8:
+    return batch_heapbased<ward_D2_linkage>(groups, threads, queue);
+  case 9:
+    return batch_single(groups, threads);
+  }
+
+  stop("unsupported linkage method");
+}
+
+// [[Rcpp::export(.hclust1d_batch)]]
+List hclust1d_batch(List & points_list, int method, CharacterVector & method_name, RObject call, int threads = 1, bool columnar = false, int queue = 0) {
+// points_list: a list of numeric vectors of at least 2 points each
+// columnar: a list of hclust objects (false), or a single list of the merges, the heights and the orders
+//           of all the groups concatenated, with the offsets of the groups (true)
+
+  int groups_size = points_list.size();
+
+  std::vector<NumericVector> points(groups_size);   //keeps the coerced vectors alive
+  std::vector<batch_group> groups(groups_size);
+  for (int g = 0; g < groups_size; g++) {
+    points[g] = points_list[g];
+    groups[g].points = points[g].begin();
+    groups[g].points_size = points[g].size();
+  }
+
+  if (columnar) {
+    IntegerVector offsets(groups_size + 1);
+    for (int g = 0; g < groups_size; g++)
+      offsets[g + 1] = offsets[g] + groups[g].points_size;
+    int points_total = offsets[groups_size];
+
+    IntegerMatrix merge(points_total - groups_size, 2);
+    NumericVector height(points_total - groups_size);
+    IntegerVector order_points(points_total);
+    for (int g = 0; g < groups_size; g++) {
+      groups[g].order_points = &order_points[offsets[g]];
+      groups[g].merge_left = &merge(offsets[g] - g, 0);
+      groups[g].merge_right = &merge(offsets[g] - g, 1);
+      groups[g].height = &height[offsets[g] - g];
+    }
+
+    batch(groups, method, threads, queue);
+
+    return List::create(Named("merge")=merge, Named("height")=height, Named("order")=order_points, Named("offsets")=offsets, Named("method")=method_name, Named("dist.method")="euclidean");
+  }
+
+  std::vector<IntegerMatrix> merges(groups_size);
+  std::vector<NumericVector> heights(groups_size);
+  std::vector<IntegerVector> orders(groups_size);
+  for (int g = 0; g < groups_size; g++) {
+    int points_size = groups[g].points_size;
+    merges[g] = IntegerMatrix(points_size - 1, 2);
+    heights[g] = NumericVector(points_size - 1);
+    orders[g] = IntegerVector(points_size);
+    groups[g].order_points = orders[g].begin();
+    groups[g].merge_left = &merges[g](0, 0);
+    groups[g].merge_right = &merges[g](0, 1);
+    groups[g].height = heights[g].begin();
+  }
+
+  batch(groups, method, threads, queue);
+
+  List ret(groups_size);
+  for (int g = 0; g < groups_size; g++) {
+    List dendrogram = List::create(Named("merge")=merges[g], Named("height")=heights[g], Named("order")=orders[g], Named("labels")=point_labels(points[g], auto_labels), Named("method")=method_name, Named("dist.method")="euclidean", Named("call")=call);
+    dendrogram.attr("class") = "hclust";
+    ret[g] = dendrogram;
+  }
+
+  return ret;
+}
@@ -0,0 +1,38 @@
+#include <Rcpp.h>
+#include <cstdint>  //std::uint32_t
+#include "bootstrap.h"
+
+using namespace Rcpp;
+
+// [[Rcpp::export(.hclust1d_bootstrap)]]
+SEXP hclust1d_bootstrap(NumericVector & points, int resamples, int method, int k, IntegerVector & seed,
+                        bool coclustering = false, int threads = 1, int queue = 0) {
+// resamples of the points clustered and cut into k clusters, see bootstrap.h
+// methods as in hclust1d_heapbased.cpp, and 9 - single
+// seed: bootstrap_seed_size integers drawn by R, so that set.seed() sets the resamples
+// returns the memberships (NA for the points not drawn) with an attribute "counts", or the co-clustering frequencies
+
+  int points_size = points.size();
+  std::uint32_t resamples_seed[bootstrap_seed_size];
+  for (int i = 0; i < bootstrap_seed_size; i++)
+    resamples_seed[i] = (std::uint32_t)seed[i];
+
+  if (coclustering) {
+    NumericMatrix frequencies(points_size, points_size);
+    bootstrap_clusters(points.begin(), points_size, resamples, method, k, resamples_seed, threads, queue,
+                       NULL, NULL, &frequencies(0, 0));
+    return frequencies;
+  }
+
+  IntegerMatrix memberships(points_size, resamples);
+  IntegerMatrix counts(points_size, resamples);
+  bootstrap_clusters(points.begin(), points_size, resamples, method, k, resamples_seed, threads, queue,
+                     memberships.begin(), counts.begin(), NULL);
+
+  for (int & membership: memberships)
+    if (membership == 0)
+      membership = NA_INTEGER;
+  memberships.attr("counts") = counts;
+
+  return memberships;
+}
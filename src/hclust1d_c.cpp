@@ -0,0 +1,196 @@
+#include <new>  //std::bad_alloc, std::nothrow
+#include <cmath>  //std::isfinite
+#include <vector>  //std::vector
+#include <cstring>  //std::memcpy
+#include <stdexcept>  //std::length_error, std::domain_error, std::invalid_argument
+#include "hclust1d_c.h"
+#include "heapbased.h"
+#include "nnchain.h"
+#include "single.h"
+#include "multi.h"
+#include "external_sort.h"
+#include "single_file.h"
+#include "dendrogram_file.h"
+#include "workspace.h"
+
+//the same workspaces (by their types) as the R adapters take, see hclust1d_heapbased.cpp and hclust1d_nnchain.cpp
+
+template <class linkage>
+static void heapbased_cluster(const double * points, int points_size, struct hclust1d_workspace & workspace,
+                              int * merge_left, int * merge_right, double * height, int * order_points) {
+  heapbased_workspace<linkage, struct heap> & w = reused<heapbased_workspace<linkage, struct heap> >(workspace);
+  dendrogram_sink merges = {merge_left, merge_right, height};
+  heapbased_merges(points, points_size, w, order_points, merges);
+}
+
+template <class linkage>
+static void nnchain_cluster(const double * points, int points_size, int threads, struct hclust1d_workspace & workspace,
+                            int * merge_left, int * merge_right, double * height, int * order_points) {
+  nnchain_workspace<linkage> & w = reused<nnchain_workspace<linkage> >(workspace);
+  nnchain_merges(points, points_size, threads, w, order_points, merge_left, merge_right, height);
+}
+
+static int cluster(const double * points, int points_size, int method, int threads, struct hclust1d_workspace & workspace,
+                   int * merge_left, int * merge_right, double * height, int * order_points) {
+  switch (method) {
+  case HCLUST1D_SINGLE_IMPLEMENTED_BY_HEAP:
+    heapbased_cluster<single_linkage>(points, points_size, workspace, merge_left, merge_right, height, order_points);
+    return HCLUST1D_OK;
+  case HCLUST1D_COMPLETE:
+    nnchain_cluster<complete_linkage>(points, points_size, threads, workspace, merge_left, merge_right, height, order_points);
+    return HCLUST1D_OK;
+  case HCLUST1D_AVERAGE:
+    nnchain_cluster<average_linkage>(points, points_size, threads, workspace, merge_left, merge_right, height, order_points);
+    return HCLUST1D_OK;
+  case HCLUST1D_CENTROID:
+    heapbased_cluster<centroid_linkage>(points, points_size, workspace, merge_left, merge_right, height, order_points);
+    return HCLUST1D_OK;
+  case HCLUST1D_TRUE_MEDIAN:
+    heapbased_cluster<true_median_linkage>(points, points_size, workspace, merge_left, merge_right, height, order_points);
+    return HCLUST1D_OK;
+  case HCLUST1D_MEDIAN:
+    heapbased_cluster<median_linkage>(points, points_size, workspace, merge_left, merge_right, height, order_points);
+    return HCLUST1D_OK;
+  case HCLUST1D_MCQUITTY:
+    nnchain_cluster<mcquitty_linkage>(points, points_size, threads, workspace, merge_left, merge_right, height, order_points);
+    return HCLUST1D_OK;
+  case HCLUST1D_WARD_D:
+    nnchain_cluster<ward_D_linkage>(points, points_size, threads, workspace, merge_left, merge_right, height, order_points);
+    return HCLUST1D_OK;
+  case HCLUST1D_WARD_D2:
+    nnchain_cluster<ward_D2_linkage>(points, points_size, threads, workspace, merge_left, merge_right, height, order_points);
+    return HCLUST1D_OK;
+  case HCLUST1D_SINGLE:
+    single_merges(points, points_size, threads, reused<struct single_workspace>(workspace),
+                  order_points, merge_left, merge_right, height);
+    return HCLUST1D_OK;
+  }
+
+  return HCLUST1D_UNSUPPORTED_METHOD;
+}
+
+extern "C" struct hclust1d_workspace * hclust1d_workspace_new(void) {
+  return new (std::nothrow) struct hclust1d_workspace;
+}
+
+extern "C" void hclust1d_workspace_delete(struct hclust1d_workspace * workspace) {
+  delete workspace;
+}
+
+static int points_status(const double * points, int points_size) {
+  if (points_size < 2)
+    return HCLUST1D_TOO_FEW_POINTS;
+  for (int i = 0; i < points_size; i++)
+    if (not std::isfinite(points[i]))
+      return HCLUST1D_NOT_FINITE;
+  return HCLUST1D_OK;
+}
+
+extern "C" int hclust1d_cluster(const double * points, int points_size, int method, int threads,
+                                struct hclust1d_workspace * workspace,
+                                int * merge_left, int * merge_right, double * height, int * order) {
+  int status = points_status(points, points_size);
+  if (status != HCLUST1D_OK)
+    return status;
+  if (threads < 1)
+    threads = 1;
+
+  //no exception may cross the C interface
+  try {
+    struct hclust1d_workspace temporary;
+    return cluster(points, points_size, method, threads, workspace != NULL ? *workspace : temporary,
+                   merge_left, merge_right, height, order);
+  } catch (std::bad_alloc &) {
+    return HCLUST1D_OUT_OF_MEMORY;
+  } catch (...) {
+    return HCLUST1D_FAILED;
+  }
+}
+
+extern "C" int hclust1d_cluster_methods(const double * points, int points_size, const int * methods, int methods_size, int threads,
+                                        struct hclust1d_workspace * workspace,
+                                        int ** merge_left, int ** merge_right, double ** height, int * order) {
+  int status = points_status(points, points_size);
+  if (status != HCLUST1D_OK)
+    return status;
+  if (methods_size < 1)
+    return HCLUST1D_UNSUPPORTED_METHOD;
+  if (threads < 1)
+    threads = 1;
+
+  try {
+    std::vector<linkage_dendrogram> linkages(methods_size);
+    for (int m = 0; m < methods_size; m++)
+      linkages[m] = {methods[m], merge_left[m], merge_right[m], height[m], NULL};
+
+    struct hclust1d_workspace temporary;
+    multi_merges(points, points_size, linkages, threads, binary_heap_backend, false,
+                 workspace != NULL ? *workspace : temporary, order);
+    return HCLUST1D_OK;
+  } catch (std::invalid_argument &) {
+    return HCLUST1D_UNSUPPORTED_METHOD;
+  } catch (std::bad_alloc &) {
+    return HCLUST1D_OUT_OF_MEMORY;
+  } catch (...) {
+    return HCLUST1D_FAILED;
+  }
+}
+
+extern "C" int hclust1d_cluster_file(const char * points_path, int method, const char * merges_path, const char * order_path,
+                                     long long memory, const char * temporary_directory) {
+  if (method != HCLUST1D_SINGLE)
+    return HCLUST1D_UNSUPPORTED_METHOD;
+
+  try {
+    single_merges_file(points_path, merges_path, order_path != NULL ? order_path : "", memory, temporary_directory);
+    return HCLUST1D_OK;
+  } catch (std::length_error &) {
+    return HCLUST1D_TOO_FEW_POINTS;
+  } catch (std::domain_error &) {
+    return HCLUST1D_NOT_FINITE;
+  } catch (file_error &) {
+    return HCLUST1D_FILE_ERROR;
+  } catch (std::bad_alloc &) {
+    return HCLUST1D_OUT_OF_MEMORY;
+  } catch (...) {
+    return HCLUST1D_FAILED;
+  }
+}
+
+//the names of the methods in hclust in R, by their numbers
+static const char * method_names[] = {"single_implemented_by_heap", "complete", "average", "centroid", "true_median",
+                                      "median", "mcquitty", "ward.D", "ward.D2", "single"};
+
+extern "C" int hclust1d_cluster_save(const double * points, int points_size, int method, int threads,
+                                     struct hclust1d_workspace * workspace, const char * path, int value_labels) {
+  int status = points_status(points, points_size);
+  if (status != HCLUST1D_OK)
+    return status;
+  if (method < HCLUST1D_SINGLE_IMPLEMENTED_BY_HEAP or method > HCLUST1D_SINGLE)
+    return HCLUST1D_UNSUPPORTED_METHOD;
+  if (threads < 1)
+    threads = 1;
+
+  try {
+    dendrogram_file file(path, points_size, value_labels ? value_dendrogram_labels : no_dendrogram_labels);
+    int * order = file.order();
+    struct hclust1d_workspace temporary;
+    status = cluster(points, points_size, method, threads, workspace != NULL ? *workspace : temporary,
+                     file.merge_left(), file.merge_right(), file.height(), order);
+    if (status != HCLUST1D_OK)
+      return status;
+
+    for (int i = 0; i < points_size; i++)
+      order[i]++;    //R conformant
+    if (value_labels)
+      std::memcpy(file.label_values(), points, points_size * sizeof(double));
+    file.finish(method_names[method], "euclidean");
+    return HCLUST1D_OK;
+  } catch (file_error &) {
+    return HCLUST1D_FILE_ERROR;
+  } catch (std::bad_alloc &) {
+    return HCLUST1D_OUT_OF_MEMORY;
+  } catch (...) {
+    return HCLUST1D_FAILED;
+  }
+}
@@ -0,0 +1,93 @@
+#ifndef HCLUST1D_C_H
+
+#define HCLUST1D_C_H
+
+/*
+ *                     the C interface of hclust1d
+ *
+ * clustering of points in caller's buffers, outside R: no R objects, no copies of the points,
+ * and the results written straight to the arrays given, each with at least the number of elements noted
+ *
+ * * merge_left, merge_right (points_size - 1) - the merges, encoded as in hclust in R:
+ *   -(i + 1) for the point i, and s + 1 for the cluster merged at the stage s
+ * * height (points_size - 1) - the heights of the merges, as in hclust in R
+ * * order (points_size) - the (0-based) indices of the points in the increasing order
+ *
+ * the reducible linkages are clustered with the nearest-neighbour chain, the others with the binary heap,
+ * and the results are the same as of hclust1d() in R
+ *
+ * hclust1d_cluster_methods() clusters the same points with several methods, over a single sort (see multi.h)
+ *
+ * hclust1d_cluster_file() does the same for points in a file, writing the results to files, out of core
+ *
+ * hclust1d_cluster_save() writes the dendrogram to a dendrogram file (see dendrogram_file.h), straight from the merge loop
+ *
+ * with a workspace given (see workspace.h) the buffers of the merge loops are reused over calls,
+ * with NULL they are allocated for the call; a workspace must not be used by two calls at the same time
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* numbered as the methods in hclust1d_heapbased.cpp */
+enum hclust1d_method {
+  HCLUST1D_SINGLE_IMPLEMENTED_BY_HEAP = 0,
+  HCLUST1D_COMPLETE = 1,
+  HCLUST1D_AVERAGE = 2,
+  HCLUST1D_CENTROID = 3,
+  HCLUST1D_TRUE_MEDIAN = 4,
+  HCLUST1D_MEDIAN = 5,
+  HCLUST1D_MCQUITTY = 6,
+  HCLUST1D_WARD_D = 7,
+  HCLUST1D_WARD_D2 = 8,
+  HCLUST1D_SINGLE = 9
+};
+
+enum hclust1d_status {
+  HCLUST1D_OK = 0,
+  HCLUST1D_TOO_FEW_POINTS = 1,   /* fewer than 2 */
+  HCLUST1D_NOT_FINITE = 2,   /* a point is NaN or infinite */
+  HCLUST1D_UNSUPPORTED_METHOD = 3,
+  HCLUST1D_OUT_OF_MEMORY = 4,
+  HCLUST1D_FAILED = 5,
+  HCLUST1D_FILE_ERROR = 6   /* a file cannot be opened, read or written */
+};
+
+struct hclust1d_workspace;
+
+/* NULL if out of memory */
+struct hclust1d_workspace * hclust1d_workspace_new(void);
+void hclust1d_workspace_delete(struct hclust1d_workspace * workspace);
+
+/* threads is used by HCLUST1D_SINGLE and by the reducible linkages, as in hclust1d() in R;
+   returns one of hclust1d_status */
+int hclust1d_cluster(const double * points, int points_size, int method, int threads,
+                     struct hclust1d_workspace * workspace,
+                     int * merge_left, int * merge_right, double * height, int * order);
+
+/* each of the methods given at most once, with the merges and the heights of methods[m] written to merge_left[m],
+   merge_right[m] and height[m], and the order shared; the threads are spread over the methods;
+   returns one of hclust1d_status (HCLUST1D_UNSUPPORTED_METHOD also for a method repeated) */
+int hclust1d_cluster_methods(const double * points, int points_size, const int * methods, int methods_size, int threads,
+                             struct hclust1d_workspace * workspace,
+                             int ** merge_left, int ** merge_right, double ** height, int * order);
+
+/* out of core, for the points in a binary file of native doubles, with the merges and the order written to files
+   in the layout described in single_file.h; order_path may be NULL; memory is the budget in bytes,
+   and the temporary files go to temporary_directory; only HCLUST1D_SINGLE is supported;
+   returns one of hclust1d_status */
+int hclust1d_cluster_file(const char * points_path, int method, const char * merges_path, const char * order_path,
+                          long long memory, const char * temporary_directory);
+
+/* the dendrogram of a method written to the file at path, with no labels, or with the points as the labels
+   if value_labels is not 0 (formatted when read in R, see hclust1d_load()); returns one of hclust1d_status */
+int hclust1d_cluster_save(const double * points, int points_size, int method, int threads,
+                          struct hclust1d_workspace * workspace, const char * path, int value_labels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
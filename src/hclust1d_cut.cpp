@@ -0,0 +1,199 @@
+#include <Rcpp.h>
+#include <vector>  //std::vector
+#include <algorithm>  //std::nth_element, std::sort, std::fill, std::min_element, std::max_element
+#include <climits>  //INT_MAX
+#include "heapbased.h"
+#include "hclust1d_cut.h"
+
+using namespace Rcpp;
+
+// cutting a dendrogram into clusters without building it
+//
+// in 1D the clusters are contiguous in the sorted order, so a cut is just a set of breakpoints:
+// the intervals (between the sorted points i and i + 1) that are not merged yet. With the stage at which each interval
+// gets merged (its rank), the cut into k clusters has the breakpoints at the intervals of ranks n - k and above
+//
+// * for single linkage the ranks are the ranks of the distances, and only the k - 1 greatest are needed
+// * for the other linkages the merge loop stops as soon as the fewest clusters asked for remain
+
+//stops the merge loop after a given number of merges or after the first merge above a given height
+struct cut_sink {
+  std::vector<int> & ranks;   //the stage of merging for each interval, INT_MAX if not merged
+  std::vector<double> & heights;
+  int stages;
+  double max_height;
+
+  inline bool operator()(int stage, int id, double key, int left_merge, int right_merge) {
+    ranks[id] = stage;
+    heights.push_back(key);
+    return stage + 1 < stages and key <= max_height;
+  }
+};
+
+template <class linkage, class queue>
+void cut_heapbased(NumericVector & points, std::vector<int> & order_points, std::vector<int> & ranks,
+                   std::vector<double> & heights, int stages, double max_height) {
+  heapbased_workspace<linkage, queue> w;
+  cut_sink merges = {ranks, heights, stages, max_height};
+  heapbased_merges(points.begin(), points.size(), w, order_points.data(), merges);
+}
+
+template <class linkage>
+void cut_heapbased(NumericVector & points, std::vector<int> & order_points, std::vector<int> & ranks,
+                   std::vector<double> & heights, int stages, double max_height, int queue) {
+  switch (queue) {
+  case binary_heap_backend:
+    return cut_heapbased<linkage, struct heap>(points, order_points, ranks, heights, stages, max_height);
+  case quaternary_heap_backend:
+    return cut_heapbased<linkage, struct quaternary_heap>(points, order_points, ranks, heights, stages, max_height);
+  case tournament_tree_backend:
+    return cut_heapbased<linkage, struct tournament_tree>(points, order_points, ranks, heights, stages, max_height);
+  }
+
+  stop("unsupported priority queue backend");
+}
+
+void cut_heapbased(NumericVector & points, int method, std::vector<int> & order_points, std::vector<int> & ranks,
+                   std::vector<double> & heights, int stages, double max_height, int queue) {
+  switch (method) {
+  case 0:
+    return cut_heapbased<single_linkage>(points, order_points, ranks, heights, stages, max_height, queue);
+  case 1:
+    return cut_heapbased<complete_linkage>(points, order_points, ranks, heights, stages, max_height, queue);
+  case 2:
+    return cut_heapbased<average_linkage>(points, order_points, ranks, heights, stages, max_height, queue);
+  case 3:
+    return cut_heapbased<centroid_linkage>(points, order_points, ranks, heights, stages, max_height, queue);
+  case 4:
+    return cut_heapbased<true_median_linkage>(points, order_points, ranks, heights, stages, max_height, queue);
+  case 5:
+    return cut_heapbased<median_linkage>(points, order_points, ranks, heights, stages, max_height, queue);
+  case 6:
+    return cut_heapbased<mcquitty_linkage>(points, order_points, ranks, heights, stages, max_height, queue);
+  case 7:
+    return cut_heapbased<ward_D_linkage>(points, order_points, ranks, heights, stages, max_height, queue);
+  case 8:
+    return cut_heapbased<ward_D2_linkage>(points, order_points, ranks, heights, stages, max_height, queue);
+  }
+
+  stop("unsupported linkage method");
+}
+
+//the cluster memberships for the breakpoints, numbered in the order of the first appearance in points (as in cutree)
+void memberships(const std::vector<int> & order_points, const std::vector<int> & ranks, int min_rank,
+                 std::vector<int> & sorted_clusters, int * membership) {
+  int points_size = order_points.size();
+
+  int cluster = 0;
+  for (int i = 0; i < points_size; i++) {
+    membership[order_points[i]] = cluster;
+    if (i < points_size - 1 and ranks[i] >= min_rank)
+      cluster++;
+  }
+
+  std::fill(sorted_clusters.begin(), sorted_clusters.begin() + cluster + 1, 0);
+  int numbered = 0;
+  for (int i = 0; i < points_size; i++) {
+    int & number = sorted_clusters[membership[i]];
+    if (number == 0)
+      number = ++numbered;
+    membership[i] = number;
+  }
+}
+
+// [[Rcpp::export(.hclust1d_cut)]]
+IntegerMatrix hclust1d_cut(NumericVector & points, int method, IntegerVector & k, NumericVector & h, int queue = 0) {
+// methods as in hclust1d_heapbased.cpp, and 9 - single
+// either k (the numbers of clusters) or h (the heights) is given, the other is empty
+// returns the memberships for each of k or h in the columns
+
+  int points_size = points.size();
+  int cuts_size = k.size() > 0 ? k.size() : h.size();
+  bool by_height = k.size() == 0;
+
+  std::vector<int> order_points(points_size);
+  std::vector<int> ranks(points_size - 1, INT_MAX);
+  std::vector<double> heights;   //by the stages, for the stages run
+  std::vector<int> cuts_k(k.begin(), k.end());
+
+  if (method == 9) {
+    // single linkage: the distances are the heights, and the merges follow the (distance, interval) order
+    order(points.begin(), points_size, order_points.data());
+    std::fill(ranks.begin(), ranks.end(), -1);   // merged before any of the ranks that matter
+
+    std::vector<double> distances(points_size - 1);
+    for (int i = 0; i < points_size - 1; i++)
+      distances[i] = points[order_points[i + 1]] - points[order_points[i]];
+
+    if (by_height) {
+      // the breakpoints are at the distances above h, ranked as if they came last
+      double min_height = *std::min_element(h.begin(), h.end());
+      for (int j = 0; j < cuts_size; j++) {
+        cuts_k.push_back(1);
+        for (int i = 0; i < points_size - 1; i++)
+          if (distances[i] > h[j])
+            cuts_k[j]++;
+      }
+
+      // the intervals above the smallest h get the greatest ranks, in the (distance, interval) order
+      std::vector<int> greatest;
+      for (int i = 0; i < points_size - 1; i++)
+        if (distances[i] > min_height)
+          greatest.push_back(i);
+      std::sort(greatest.begin(), greatest.end(), [&](int a, int b) {
+        return distances[a] < distances[b] or (distances[a] == distances[b] and a < b);
+      });
+      int above = greatest.size();
+      for (int r = 0; r < above; r++)
+        ranks[greatest[r]] = points_size - 1 - above + r;
+    } else {
+      // only the ranks of the max(k) - 1 greatest distances matter
+      int greatest_size = *std::max_element(cuts_k.begin(), cuts_k.end()) - 1;
+      std::vector<int> intervals(points_size - 1);
+      for (int i = 0; i < points_size - 1; i++)
+        intervals[i] = i;
+      auto precedes = [&](int a, int b) {
+        return distances[a] < distances[b] or (distances[a] == distances[b] and a < b);
+      };
+      std::nth_element(intervals.begin(), intervals.end() - greatest_size, intervals.end(), precedes);
+      std::sort(intervals.end() - greatest_size, intervals.end(), precedes);
+      for (int r = points_size - 1 - greatest_size; r < points_size - 1; r++)
+        ranks[intervals[r]] = r;
+    }
+  } else {
+    bool monotone = method != 3 and method != 4 and method != 5;   // centroid, true_median and median may have inversions
+    int stages = points_size - 1;
+    double max_height = R_PosInf;
+
+    if (not by_height)
+      stages = points_size - *std::min_element(cuts_k.begin(), cuts_k.end());
+    else if (monotone)
+      max_height = *std::max_element(h.begin(), h.end());   // the loop stops at the first height above it
+
+    if (stages > 0)
+      cut_heapbased(points, method, order_points, ranks, heights, stages, max_height, queue);
+    else
+      order(points.begin(), points_size, order_points.data());
+
+    if (by_height) {
+      for (size_t stage = 1; stage < heights.size(); stage++)
+        if (heights[stage] < heights[stage - 1])
+          stop("the 'height' component of 'tree' is not sorted (increasingly)");
+
+      // as in cutree: the number of merges before the first height above h
+      for (int j = 0; j < cuts_size; j++) {
+        int merges_below = 0;
+        while (merges_below < (int)heights.size() and heights[merges_below] <= h[j])
+          merges_below++;
+        cuts_k.push_back(points_size - merges_below);
+      }
+    }
+  }
+
+  IntegerMatrix ret(points_size, cuts_size);
+  std::vector<int> sorted_clusters(points_size);
+  for (int j = 0; j < cuts_size; j++)
+    memberships(order_points, ranks, points_size - cuts_k[j], sorted_clusters, &ret(0, j));
+
+  return ret;
+}
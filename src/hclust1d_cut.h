@@ -0,0 +1,13 @@
+#ifndef HCLUST1D_CUT_H
+
+#define HCLUST1D_CUT_H
+#include <Rcpp.h>
+#include <vector>  //std::vector
+
+//the merge loop of a given linkage run until a cut (see hclust1d_cut.cpp): for at most stages merges,
+//and up to the first merge above max_height; ranks get the stage of each interval merged (and are INT_MAX otherwise),
+//and heights the heights of the stages run. Methods as in hclust1d_heapbased.cpp
+void cut_heapbased(Rcpp::NumericVector & points, int method, std::vector<int> & order_points, std::vector<int> & ranks,
+                   std::vector<double> & heights, int stages, double max_height, int queue);
+
+#endif
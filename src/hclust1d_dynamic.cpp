@@ -0,0 +1,341 @@
+#include <Rcpp.h>
+#include <vector>  //std::vector
+#include <algorithm>  //std::sort, std::adjacent_find
+#include <iterator>  //std::next, std::prev
+#include <climits>  //INT_MAX
+#include "heapbased.h"
+#include "single.h"
+#include "labels.h"
+#include "hclust1d_cut.h"
+#include "hclust1d_dynamic.h"
+
+using namespace Rcpp;
+
+/*
+ *                     a dynamic dendrogram
+ *
+ * the points present are kept in the ordered sets of hclust1d_dynamic.h
+ *
+ * * an insert or a delete of a point changes at most two intervals, so it costs O(log n)
+ * * inserting at least as many points as there are present rebuilds both sets from sorted vectors instead,
+ *   in O(n) after sorting (with hints at the end of the sets)
+ * * as.hclust walks both sets for the order of the points and the order of the distances, so single linkage
+ *   needs only the O(n) relabel loop (see single_merges_ordered), with no sorting at all
+ * * other linkages rerun the merge loop over the points in their sorted order, so the sort is a linear
+ *   presorted pass (see order.cpp); a changed distance may change the cluster distances anywhere, so the whole loop is rerun
+ *
+ * ids are 0-based in C++ (1-based in R) in the order of insertion and are never reused;
+ * the dendrogram has the points present in the order of their ids
+ *
+ */
+
+struct dynamic_dendrogram {
+  int method;
+  std::vector<double> values;   //by ids, for all the points ever inserted
+  std::vector<bool> present;
+  int points_size;   //present
+  ordered_points sorted;
+};
+
+static dynamic_interval interval(const dynamic_point & left, const dynamic_point & right) {
+  return dynamic_interval(right.first - left.first, left.first, left.second);
+}
+
+void insert_point(ordered_points & s, const dynamic_point & inserted) {
+  auto point = s.points.insert(inserted).first;
+  auto next = std::next(point);
+  bool has_left = point != s.points.begin();
+  bool has_right = next != s.points.end();
+
+  if (has_left and has_right)
+    s.intervals.erase(interval(*std::prev(point), *next));
+  if (has_left)
+    s.intervals.insert(interval(*std::prev(point), *point));
+  if (has_right)
+    s.intervals.insert(interval(*point, *next));
+}
+
+void erase_point(ordered_points & s, const dynamic_point & erased) {
+  auto point = s.points.find(erased);
+  auto next = std::next(point);
+  bool has_left = point != s.points.begin();
+  bool has_right = next != s.points.end();
+
+  if (has_left)
+    s.intervals.erase(interval(*std::prev(point), *point));
+  if (has_right)
+    s.intervals.erase(interval(*point, *next));
+  if (has_left and has_right)
+    s.intervals.insert(interval(*std::prev(point), *next));
+
+  s.points.erase(point);
+}
+
+void assign_points(ordered_points & s, const std::vector<dynamic_point> & points) {
+  std::vector<double> values(points.size());
+  for (size_t i = 0; i < points.size(); i++)
+    values[i] = points[i].first;
+
+  //the order is stable, so the points come in the (value, id) order and the intervals in the (distance, position) order
+  std::vector<int> order_points(values.size());
+  order(values.data(), values.size(), order_points.data());
+
+  s.points.clear();
+  std::vector<dynamic_point> sorted_points;
+  for (int i: order_points) {
+    sorted_points.push_back(points[i]);
+    s.points.insert(s.points.end(), sorted_points.back());
+  }
+
+  s.intervals.clear();
+  if (sorted_points.size() < 2)
+    return;
+
+  std::vector<dynamic_interval> intervals;
+  std::vector<double> distances;
+  for (size_t i = 0; i + 1 < sorted_points.size(); i++) {
+    intervals.push_back(interval(sorted_points[i], sorted_points[i + 1]));
+    distances.push_back(std::get<0>(intervals.back()));
+  }
+  std::vector<int> order_distances(distances.size());
+  order(distances.data(), distances.size(), order_distances.data());
+  for (int i: order_distances)
+    s.intervals.insert(s.intervals.end(), intervals[i]);
+}
+
+static void rebuild(dynamic_dendrogram & d) {
+  std::vector<dynamic_point> points;
+  for (int id = 0; id < (int)d.values.size(); id++)
+    if (d.present[id])
+      points.push_back(dynamic_point(d.values[id], id));
+
+  assign_points(d.sorted, points);
+}
+
+static dynamic_dendrogram & dynamic(SEXP dendrogram) {
+  XPtr<dynamic_dendrogram> d(dendrogram);
+  if (d.get() == NULL)
+    stop("the dynamic dendrogram is no longer available (was it saved and loaded?)");
+  return *d;
+}
+
+template <class linkage, class queue>
+void dynamic_heapbased(const std::vector<double> & sorted_points, int * merge_left, int * merge_right, double * height) {
+  std::vector<int> order_sorted(sorted_points.size());
+  heapbased_workspace<linkage, queue> w;
+  dendrogram_sink merges = {merge_left, merge_right, height};
+  heapbased_merges(sorted_points.data(), sorted_points.size(), w, order_sorted.data(), merges);
+}
+
+template <class linkage>
+void dynamic_heapbased(const std::vector<double> & sorted_points, int * merge_left, int * merge_right, double * height, int queue) {
+  switch (queue) {
+  case binary_heap_backend:
+    return dynamic_heapbased<linkage, struct heap>(sorted_points, merge_left, merge_right, height);
+  case quaternary_heap_backend:
+    return dynamic_heapbased<linkage, struct quaternary_heap>(sorted_points, merge_left, merge_right, height);
+  case tournament_tree_backend:
+    return dynamic_heapbased<linkage, struct tournament_tree>(sorted_points, merge_left, merge_right, height);
+  }
+
+  stop("unsupported priority queue backend");
+}
+
+void dynamic_heapbased(const std::vector<double> & sorted_points, int method, int * merge_left, int * merge_right, double * height, int queue) {
+  switch (method) {
+  case 0:
+    return dynamic_heapbased<single_linkage>(sorted_points, merge_left, merge_right, height, queue);
+  case 1:
+    return dynamic_heapbased<complete_linkage>(sorted_points, merge_left, merge_right, height, queue);
+  case 2:
+    return dynamic_heapbased<average_linkage>(sorted_points, merge_left, merge_right, height, queue);
+  case 3:
+    return dynamic_heapbased<centroid_linkage>(sorted_points, merge_left, merge_right, height, queue);
+  case 4:
+    return dynamic_heapbased<true_median_linkage>(sorted_points, merge_left, merge_right, height, queue);
+  case 5:
+    return dynamic_heapbased<median_linkage>(sorted_points, merge_left, merge_right, height, queue);
+  case 6:
+    return dynamic_heapbased<mcquitty_linkage>(sorted_points, merge_left, merge_right, height, queue);
+  case 7:
+    return dynamic_heapbased<ward_D_linkage>(sorted_points, merge_left, merge_right, height, queue);
+  case 8:
+    return dynamic_heapbased<ward_D2_linkage>(sorted_points, merge_left, merge_right, height, queue);
+  }
+
+  stop("unsupported linkage method");
+}
+
+// [[Rcpp::export(.dynamic_dendrogram)]]
+SEXP dynamic_dendrogram_create(int method) {
+// methods as in hclust1d_heapbased.cpp, and 9 - single
+
+  dynamic_dendrogram * d = new dynamic_dendrogram;
+  d->method = method;
+  d->points_size = 0;
+  return XPtr<dynamic_dendrogram>(d, true);
+}
+
+// [[Rcpp::export(.dynamic_insert)]]
+IntegerVector dynamic_insert(SEXP dendrogram, NumericVector & points) {
+// returns the (1-based) ids of the points inserted
+
+  dynamic_dendrogram & d = dynamic(dendrogram);
+
+  IntegerVector ids(points.size());
+  bool bulk = points.size() >= d.points_size;
+  for (int i = 0; i < points.size(); i++) {
+    ids[i] = d.values.size() + 1;
+    d.values.push_back(points[i]);
+    d.present.push_back(true);
+    d.points_size++;
+    if (not bulk)
+      insert_point(d.sorted, dynamic_point(points[i], ids[i] - 1));
+  }
+
+  if (bulk)
+    rebuild(d);
+
+  return ids;
+}
+
+// [[Rcpp::export(.dynamic_delete)]]
+void dynamic_delete(SEXP dendrogram, IntegerVector & ids) {
+// ids are 1-based, all of them get checked before any gets deleted
+
+  dynamic_dendrogram & d = dynamic(dendrogram);
+
+  std::vector<int> sorted_ids(ids.begin(), ids.end());
+  std::sort(sorted_ids.begin(), sorted_ids.end());
+  if (std::adjacent_find(sorted_ids.begin(), sorted_ids.end()) != sorted_ids.end())
+    stop("ids must not be repeated");
+  for (int id: sorted_ids)
+    if (id == NA_INTEGER or id < 1 or id > (int)d.values.size() or not d.present[id - 1])
+      stop("ids must be the ids of points present in the dendrogram");
+
+  for (int id: sorted_ids) {
+    d.present[id - 1] = false;
+    d.points_size--;
+    erase_point(d.sorted, dynamic_point(d.values[id - 1], id - 1));
+  }
+}
+
+List ordered_hclust(const ordered_points & s, NumericVector & points, const std::vector<int> & positions,
+                    std::int64_t first_id, int method, int queue) {
+
+  int points_size = points.size();
+  IntegerVector order_points(points_size);
+  std::vector<int> sorted_positions(positions.size());   //of the points present, by ids from first_id on
+  std::vector<double> sorted_points(points_size);
+  int position = 0;
+  for (const dynamic_point & point: s.points) {
+    sorted_positions[point.second - first_id] = position;
+    sorted_points[position] = point.first;
+    order_points[position++] = positions[point.second - first_id];
+  }
+
+  IntegerMatrix merge(points_size - 1, 2);
+  NumericVector height(points_size - 1);
+
+  if (method == 9) {
+    std::vector<double> distances(points_size - 1);
+    std::vector<int> order_distances(points_size - 1);
+    int stage = 0;
+    for (const dynamic_interval & interval: s.intervals) {
+      int i = sorted_positions[std::get<2>(interval) - first_id];
+      distances[i] = std::get<0>(interval);
+      order_distances[stage++] = i;
+    }
+
+    struct single_workspace w;
+    single_merges_ordered(order_points.begin(), points_size, distances.data(), order_distances.data(), 1, w,
+                          &merge(0, 0), &merge(0, 1), height.begin());
+  } else {
+    //the merge loop sees the points sorted, so the singletons get relabelled from the sorted positions
+    dynamic_heapbased(sorted_points, method, &merge(0, 0), &merge(0, 1), height.begin(), queue);
+    for (int stage = 0; stage < points_size - 1; stage++)
+      for (int column = 0; column < 2; column++)
+        if (merge(stage, column) < 0)
+          merge(stage, column) = -order_points[-merge(stage, column) - 1] - 1;
+  }
+
+  for (int i=0; i<points_size; i++)
+    order_points[i]++;    //make it R conformant, in place
+
+  List ret = List::create(Named("merge")=merge, Named("height")=height, Named("order")=order_points, Named("labels")=point_labels(points, auto_labels), Named("method")="to_be_overwritten", Named("dist.method")="euclidean");
+  ret.attr("class") = "hclust";
+
+  return ret;
+}
+
+std::vector<dynamic_point> breakpoints(const ordered_points & s, int method, int k, double h, int queue) {
+  std::vector<dynamic_point> ret;
+  int points_size = s.points.size();
+  if (points_size < 2)
+    return ret;
+
+  if (method == 9) {
+    //the intervals merged last, the greatest distances, are the last ones in the set
+    int taken = 0;
+    for (auto interval = s.intervals.rbegin(); interval != s.intervals.rend(); ++interval, taken++) {
+      if (k > 0 ? taken == k - 1 : std::get<0>(*interval) <= h)
+        break;
+      ret.push_back(dynamic_point(std::get<1>(*interval), std::get<2>(*interval)));
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+  }
+
+  //the same as in hclust1d_cut.cpp, on the points in their sorted order
+  std::vector<dynamic_point> sorted(s.points.begin(), s.points.end());
+  NumericVector sorted_points(points_size);
+  for (int i = 0; i < points_size; i++)
+    sorted_points[i] = sorted[i].first;
+
+  bool monotone = method != 3 and method != 4 and method != 5;   // centroid, true_median and median may have inversions
+  int stages = k > 0 ? points_size - k : points_size - 1;
+  double max_height = k == 0 and monotone ? h : R_PosInf;
+
+  std::vector<int> order_points(points_size);
+  std::vector<int> ranks(points_size - 1, INT_MAX);
+  std::vector<double> heights;
+  if (stages > 0)
+    cut_heapbased(sorted_points, method, order_points, ranks, heights, stages, max_height, queue);
+
+  if (k == 0) {
+    for (size_t stage = 1; stage < heights.size(); stage++)
+      if (heights[stage] < heights[stage - 1])
+        stop("the 'height' component of 'tree' is not sorted (increasingly)");
+    int merges_below = 0;
+    while (merges_below < (int)heights.size() and heights[merges_below] <= h)
+      merges_below++;
+    k = points_size - merges_below;
+  }
+
+  for (int i = 0; i < points_size - 1; i++)
+    if (ranks[i] >= points_size - k)
+      ret.push_back(sorted[i]);
+  return ret;
+}
+
+// [[Rcpp::export(.dynamic_hclust)]]
+List dynamic_hclust(SEXP dendrogram, int queue = 0) {
+
+  dynamic_dendrogram & d = dynamic(dendrogram);
+
+  int points_size = d.points_size;
+  if (points_size < 2)
+    stop("at least two objects are needed to analyse clusters with hclust1d");
+
+  //the positions of the points present, in the order of ids
+  std::vector<int> positions(d.values.size());
+  NumericVector points(points_size);
+  int position = 0;
+  for (int id = 0; id < (int)d.values.size(); id++)
+    if (d.present[id]) {
+      positions[id] = position;
+      points[position++] = d.values[id];
+    }
+
+  return ordered_hclust(d.sorted, points, positions, 0, d.method, queue);
+}
@@ -0,0 +1,54 @@
+#ifndef HCLUST1D_DYNAMIC_H
+
+#define HCLUST1D_DYNAMIC_H
+#include <Rcpp.h>
+#include <vector>  //std::vector
+#include <set>  //std::set
+#include <tuple>  //std::tuple
+#include <utility>  //std::pair
+#include <cstdint>  //std::int64_t
+
+/*
+ *                     the ordered sets of a changing set of points
+ *
+ * the points are kept in an ordered set by (value, id), and the intervals between consecutive points
+ * in an ordered set by (distance, left value, left id), which is the order of merges of single linkage
+ * (the ties between distances resolved by the interval position, as everywhere else)
+ *
+ * shared by the dynamic dendrogram (see hclust1d_dynamic.cpp) and the sliding window (see hclust1d_window.cpp),
+ * with ids given in the order of insertion, so that the ties between equal values are resolved as in hclust1d()
+ * of the points in the order of their ids
+ *
+ * * insert_point() and erase_point() change at most two intervals, so they cost O(log n)
+ * * assign_points() rebuilds both sets from the points in the order of their ids, in O(n) after sorting
+ * * ordered_hclust() makes the hclust object of the points present, with no sorting: single linkage
+ *   only relabels the merges in the order of the intervals, the other linkages rerun the merge loop
+ *   over the points in their sorted order (a linear presorted pass in order.cpp)
+ * * breakpoints() gives the left points of the intervals not merged in the cut at k clusters, or at the height h
+ *   (if k is 0): single linkage takes them straight from the end of the intervals, in O(k) (or in O(number of breakpoints)),
+ *   the other linkages rerun the merge loop until the cut
+ *
+ */
+
+typedef std::pair<double, std::int64_t> dynamic_point;   //value, id
+typedef std::tuple<double, double, std::int64_t> dynamic_interval;   //distance, left value, left id
+
+struct ordered_points {
+  std::set<dynamic_point> points;
+  std::set<dynamic_interval> intervals;
+};
+
+void insert_point(ordered_points & s, const dynamic_point & point);
+void erase_point(ordered_points & s, const dynamic_point & point);
+void assign_points(ordered_points & s, const std::vector<dynamic_point> & points);
+
+//points: the values of the points present, in the order of their ids;
+//positions: the position in points of each id from first_id on (of the points present)
+//methods as in hclust1d_heapbased.cpp, and 9 - single
+Rcpp::List ordered_hclust(const ordered_points & s, Rcpp::NumericVector & points, const std::vector<int> & positions,
+                          std::int64_t first_id, int method, int queue);
+
+//in the order of the points
+std::vector<dynamic_point> breakpoints(const ordered_points & s, int method, int k, double h, int queue);
+
+#endif
@@ -0,0 +1,19 @@
+#include <Rcpp.h>
+#include <string>
+#include <stdexcept>  //std::exception
+#include "single_file.h"
+using namespace Rcpp;
+
+// [[Rcpp::export(.hclust1d_file)]]
+double hclust1d_file(std::string points, std::string merges, std::string order, double memory, std::string temporary) {
+// single linkage out of core, see single_file.h
+// order: the path of the order file, or "" for none
+// memory: the budget in bytes, temporary: the directory of the temporary files
+// returns the number of points (as a double, it may exceed an integer)
+
+  try {
+    return (double) single_merges_file(points, merges, order, (std::int64_t) memory, temporary);
+  } catch (std::exception & e) {
+    stop(e.what());
+  }
+}
@@ -0,0 +1,43 @@
+#include <Rcpp.h>
+#include <vector>  //std::vector
+#include <stdexcept>  //std::invalid_argument
+#include "cut_index.h"
+
+using namespace Rcpp;
+
+static cut_index & index_of(SEXP index) {
+  XPtr<cut_index> i(index);
+  if (i.get() == NULL)
+    stop("the index is no longer available (was it saved and loaded?)");
+  return *i;
+}
+
+// [[Rcpp::export(.cut_index_create)]]
+SEXP cut_index_create(NumericVector & points, IntegerMatrix & merge, IntegerVector & clusters) {
+// the cuts of a dendrogram of the points at the numbers of clusters given, see cut_index.h
+
+  cut_index * index = new cut_index;
+  try {
+    make_cut_index(points.begin(), points.size(), &merge(0, 0), &merge(0, 1),
+                   std::vector<int>(clusters.begin(), clusters.end()), *index);
+  } catch (std::invalid_argument & e) {
+    delete index;
+    stop(e.what());
+  }
+  return XPtr<cut_index>(index, true);
+}
+
+// [[Rcpp::export(.cut_index_predict)]]
+IntegerMatrix cut_index_predict(SEXP index, NumericVector & points, int threads = 1) {
+// returns the clusters of the points (NA for NaN) in the columns, one for each cut of the index
+
+  cut_index & i = index_of(index);
+  int points_size = points.size();
+  int levels_size = i.levels.size();
+
+  IntegerMatrix clusters(points_size, levels_size);
+  for (int l = 0; l < levels_size; l++)
+    assign_clusters(i.levels[l], points.begin(), points_size, clusters.begin() + (R_xlen_t) l * points_size, NA_INTEGER, threads);
+
+  return clusters;
+}
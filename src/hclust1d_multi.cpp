@@ -0,0 +1,55 @@
+#include <Rcpp.h>
+#include <vector>  //std::vector
+#include "multi.h"
+#include "hclust1d_workspace.h"
+#include "labels.h"
+#include "profile.h"
+
+using namespace Rcpp;
+
+// [[Rcpp::export(.hclust1d_multi)]]
+List hclust1d_multi(NumericVector & points, IntegerVector & methods, int threads = 1, int queue = 0, bool heap_only = false,
+                    int labels = 0, SEXP workspace = R_NilValue, bool profile = false) {
+// several linkages of the same points over a single sort, see multi.h
+// methods: numbered as in hclust1d_heapbased(), and 9 - single, each at most once
+// heap_only: the reducible linkages clustered by the heap-based loop too (the "heap" engine in hclust1d.R)
+// queue, labels, workspace: as in hclust1d_heapbased()
+// profile: as in hclust1d_heapbased(), for each linkage
+// returns a list of hclust objects, in the order of methods, sharing the order and the labels
+
+  int points_size = points.size();
+  int methods_size = methods.size();
+
+  IntegerVector order_points(points_size);
+  std::vector<IntegerMatrix> merges(methods_size);
+  std::vector<NumericVector> heights(methods_size);
+  std::vector<struct profile> profiles(methods_size);
+  std::vector<linkage_dendrogram> linkages(methods_size);
+  for (int m = 0; m < methods_size; m++) {
+    merges[m] = IntegerMatrix(points_size - 1, 2);
+    heights[m] = NumericVector(points_size - 1);
+    linkages[m] = {methods[m], &merges[m](0, 0), &merges[m](0, 1), heights[m].begin(), profile ? &profiles[m] : NULL};
+  }
+
+  struct hclust1d_workspace temporary;
+  multi_merges(points.begin(), points_size, linkages, threads, queue, heap_only, workspace_of(workspace, temporary),
+               order_points.begin());
+
+  for (int i=0; i<points_size; i++)
+    order_points[i]++;    //make it R conformant, in place
+
+  RObject shared_labels = point_labels(points, labels);
+  List ret(methods_size);
+  for (int m = 0; m < methods_size; m++) {
+    struct profile * p = linkages[m].p;
+    profile_skip(p);
+    List dendrogram = List::create(Named("merge")=merges[m], Named("height")=heights[m], Named("order")=order_points, Named("labels")=shared_labels, Named("method")="to_be_overwritten", Named("dist.method")="euclidean");
+    dendrogram.attr("class") = "hclust";
+    profile_lap(p, output_phase);
+    if (p != NULL)
+      dendrogram.attr("profile") = wrap(profile_values(*p));
+    ret[m] = dendrogram;
+  }
+
+  return ret;
+}
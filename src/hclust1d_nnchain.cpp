@@ -0,0 +1,72 @@
+#include <Rcpp.h>
+#include "nnchain.h"
+#include "hclust1d_workspace.h"
+#include "labels.h"
+#include "profile.h"
+
+using namespace Rcpp;
+
+template <class linkage>
+List hclust1d_nnchain(NumericVector & points, int threads, int labels, struct hclust1d_workspace & workspace, struct profile * p) {
+// the chain for a given linkage, see linkage.h and nnchain.h
+
+  int points_size = points.size();
+
+  IntegerVector order_points(points_size);
+  IntegerMatrix merge(points_size - 1 , 2 );
+  NumericVector height(points_size - 1);
+
+  nnchain_workspace<linkage> & w = reused<nnchain_workspace<linkage> >(workspace);
+  nnchain_merges(points.begin(), points_size, threads, w, order_points.begin(), &merge(0, 0), &merge(0, 1), height.begin(), p);
+
+  for (int i=0; i<points_size; i++)
+    order_points[i]++;    //make it R conformant, in place
+
+  List ret = List::create(Named("merge")=merge, Named("height")=height, Named("order")=order_points, Named("labels")=point_labels(points, labels), Named("method")="to_be_overwritten", Named("dist.method")="euclidean");
+  ret.attr("class") = "hclust";
+  profile_lap(p, output_phase);
+  if (p != NULL)
+    ret.attr("profile") = wrap(profile_values(*p));
+
+  return ret;
+}
+
+// [[Rcpp::export(.hclust1d_nnchain)]]
+List hclust1d_nnchain(NumericVector & points, int method, int threads = 1, int labels = 0, SEXP workspace = R_NilValue, bool profile = false) {
+// reducible linkages with a nearest-neighbour chain
+// methods are numbered as in hclust1d_heapbased():
+//          0 - single implemented by heap  (undocumented behaviour)
+//          1 - complete
+//          2 - average (UPGMA)
+//          6 - mcquitty (WPGMA)
+//          7 - ward.D
+//          8 - ward.D2
+// centroid, median and true_median linkages are not reducible, use hclust1d_heapbased() for them
+// threads: the number of threads merging the mutual nearest neighbours in rounds, see nnchain.h
+// labels: as in hclust1d_heapbased(), see labels.h
+// workspace: an external pointer to the buffers reused over calls, see workspace.h, or NULL
+// profile: as in hclust1d_heapbased(), see profile.h
+
+  struct hclust1d_workspace temporary;
+  struct hclust1d_workspace & w = workspace_of(workspace, temporary);
+  struct profile phases;
+  struct profile * p = profile ? &phases : NULL;
+  profile_start(p);
+
+  switch (method) {
+  case 0:
+    return hclust1d_nnchain<single_linkage>(points, threads, labels, w, p);
+  case 1:
+    return hclust1d_nnchain<complete_linkage>(points, threads, labels, w, p);
+  case 2:
+    return hclust1d_nnchain<average_linkage>(points, threads, labels, w, p);
+  case 6:
+    return hclust1d_nnchain<mcquitty_linkage>(points, threads, labels, w, p);
+  case 7:
+    return hclust1d_nnchain<ward_D_linkage>(points, threads, labels, w, p);
+  case 8:
+    return hclust1d_nnchain<ward_D2_linkage>(points, threads, labels, w, p);
+  }
+
+  stop("linkage method not reducible, it is not supported by the nearest-neighbour chain");
+}
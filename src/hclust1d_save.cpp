@@ -0,0 +1,256 @@
+#include <Rcpp.h>
+#include <R_ext/Altrep.h>
+#include <vector>  //std::vector
+#include <string>  //std::string
+#include <cstring>  //std::memcpy
+#include <cstdint>  //std::int64_t
+#include <stdexcept>  //std::exception
+#include "dendrogram_file.h"
+#include "multi.h"
+#include "hclust1d_workspace.h"
+#include "labels.h"
+
+using namespace Rcpp;
+
+/*
+ *                     dendrogram files in R
+ *
+ * the writers fill a dendrogram_file (see dendrogram_file.h): hclust1d_save() from an hclust object, and
+ * hclust1d_save_points() from the merge loop itself, which writes the merges, the heights and the order to the file
+ * mapped (through multi_merges() with a single linkage, the same loops as of hclust1d()), so no R object
+ * of the size of the dendrogram is ever made
+ *
+ * hclust1d_load() maps the file and returns an hclust object of ALTREP vectors over the mapping, making nothing
+ * of the size of the dendrogram either: each vector points at its block of the file, paging it in when read,
+ * and the mapping is shared by the vectors through an external pointer (in data1), so it lives as long as any of them.
+ * The string labels are made when read (and all of them only when R asks for the whole vector, as in labels.cpp),
+ * the labels of the values go through point_labels() over the block of the values
+ *
+ */
+
+static R_altrep_class_t mapped_integer_class;
+static R_altrep_class_t mapped_real_class;
+static R_altrep_class_t mapped_labels_class;
+
+static dendrogram_file & file_of(SEXP x) {
+  dendrogram_file * file = (dendrogram_file *) R_ExternalPtrAddr(R_altrep_data1(x));
+  if (file == NULL)
+    Rf_error("the dendrogram file is no longer mapped");   //no C++ exception may cross the ALTREP methods
+  return *file;
+}
+
+// the integer and the real vectors: data2 holds the offset of the block in the file and its length (as doubles)
+
+static R_xlen_t mapped_length(SEXP x) {
+  return (R_xlen_t) REAL(R_altrep_data2(x))[1];
+}
+
+static void * mapped_dataptr(SEXP x, Rboolean writeable) {
+  //the mapping is private, so writing changes the memory only
+  return (void *)(file_of(x).data + (std::int64_t) REAL(R_altrep_data2(x))[0]);
+}
+
+static const void * mapped_dataptr_or_null(SEXP x) {
+  return mapped_dataptr(x, FALSE);
+}
+
+static int mapped_integer_elt(SEXP x, R_xlen_t i) {
+  return ((const int *) mapped_dataptr(x, FALSE))[i];
+}
+
+static double mapped_real_elt(SEXP x, R_xlen_t i) {
+  return ((const double *) mapped_dataptr(x, FALSE))[i];
+}
+
+static SEXP mapped_vector(R_altrep_class_t mapped_class, SEXP file, std::int64_t offset, std::int64_t length) {
+  NumericVector block = NumericVector::create((double) offset, (double) length);
+  return R_new_altrep(mapped_class, file, block);
+}
+
+// the string labels: data2 holds all the labels once made (or NULL)
+
+static R_xlen_t mapped_labels_length(SEXP x) {
+  return (R_xlen_t) file_of(x).points_size();
+}
+
+static SEXP mapped_label(SEXP x, R_xlen_t i) {
+  const char * bytes;
+  std::int64_t length;
+  if (not file_of(x).label(i, bytes, length))
+    Rf_error("the labels in the dendrogram file are corrupted");
+  return Rf_mkCharLenCE(bytes, (int) length, CE_UTF8);
+}
+
+static SEXP mapped_labels_made(SEXP x) {
+  SEXP labels = R_altrep_data2(x);
+  if (labels == R_NilValue) {
+    R_xlen_t labels_size = mapped_labels_length(x);
+    labels = PROTECT(Rf_allocVector(STRSXP, labels_size));
+    for (R_xlen_t i = 0; i < labels_size; i++)
+      SET_STRING_ELT(labels, i, mapped_label(x, i));
+    R_set_altrep_data2(x, labels);
+    UNPROTECT(1);
+  }
+  return labels;
+}
+
+static void * mapped_labels_dataptr(SEXP x, Rboolean writeable) {
+  return (void *) STRING_PTR_RO(mapped_labels_made(x));
+}
+
+static const void * mapped_labels_dataptr_or_null(SEXP x) {
+  SEXP labels = R_altrep_data2(x);
+  return labels == R_NilValue ? NULL : (const void *) STRING_PTR_RO(labels);
+}
+
+static SEXP mapped_labels_elt(SEXP x, R_xlen_t i) {
+  SEXP labels = R_altrep_data2(x);
+  if (labels != R_NilValue)
+    return STRING_ELT(labels, i);
+  return mapped_label(x, i);
+}
+
+static void mapped_labels_set_elt(SEXP x, R_xlen_t i, SEXP label) {
+  SET_STRING_ELT(mapped_labels_made(x), i, label);
+}
+
+// [[Rcpp::init]]
+void init_dendrogram_file(DllInfo * dll) {
+  mapped_integer_class = R_make_altinteger_class("mapped_integer", "hclust1d", dll);
+  R_set_altrep_Length_method(mapped_integer_class, mapped_length);
+  R_set_altvec_Dataptr_method(mapped_integer_class, mapped_dataptr);
+  R_set_altvec_Dataptr_or_null_method(mapped_integer_class, mapped_dataptr_or_null);
+  R_set_altinteger_Elt_method(mapped_integer_class, mapped_integer_elt);
+
+  mapped_real_class = R_make_altreal_class("mapped_real", "hclust1d", dll);
+  R_set_altrep_Length_method(mapped_real_class, mapped_length);
+  R_set_altvec_Dataptr_method(mapped_real_class, mapped_dataptr);
+  R_set_altvec_Dataptr_or_null_method(mapped_real_class, mapped_dataptr_or_null);
+  R_set_altreal_Elt_method(mapped_real_class, mapped_real_elt);
+
+  mapped_labels_class = R_make_altstring_class("mapped_labels", "hclust1d", dll);
+  R_set_altrep_Length_method(mapped_labels_class, mapped_labels_length);
+  R_set_altvec_Dataptr_method(mapped_labels_class, mapped_labels_dataptr);
+  R_set_altvec_Dataptr_or_null_method(mapped_labels_class, mapped_labels_dataptr_or_null);
+  R_set_altstring_Elt_method(mapped_labels_class, mapped_labels_elt);
+  R_set_altstring_Set_elt_method(mapped_labels_class, mapped_labels_set_elt);
+}
+
+//the labels of a dendrogram being written: the kind of the block and the length of all the strings
+static int labels_kind(SEXP labels, std::int64_t & labels_bytes) {
+  labels_bytes = 0;
+  if (labels == R_NilValue)
+    return no_dendrogram_labels;
+  if (labelled_points(labels) != R_NilValue)
+    return value_dendrogram_labels;
+
+  R_xlen_t labels_size = XLENGTH(labels);
+  for (R_xlen_t i = 0; i < labels_size; i++) {
+    if (STRING_ELT(labels, i) == NA_STRING)
+      stop("labels must not be NA to be saved");
+    labels_bytes += std::strlen(Rf_translateCharUTF8(STRING_ELT(labels, i)));
+  }
+  return string_dendrogram_labels;
+}
+
+static void write_labels(dendrogram_file & file, SEXP labels) {
+  if (file.labels() == value_dendrogram_labels) {
+    NumericVector points(labelled_points(labels));
+    std::memcpy(file.label_values(), points.begin(), points.size() * sizeof(double));
+  } else if (file.labels() == string_dendrogram_labels) {
+    std::int64_t * offsets = file.label_offsets();
+    char * bytes = file.label_bytes();
+    R_xlen_t labels_size = XLENGTH(labels);
+    offsets[0] = 0;
+    for (R_xlen_t i = 0; i < labels_size; i++) {
+      const char * label = Rf_translateCharUTF8(STRING_ELT(labels, i));
+      size_t length = std::strlen(label);
+      std::memcpy(bytes + offsets[i], label, length);
+      offsets[i + 1] = offsets[i] + length;
+    }
+  }
+}
+
+// [[Rcpp::export(.hclust1d_save)]]
+void hclust1d_save(IntegerMatrix & merge, NumericVector & height, IntegerVector & order, SEXP labels,
+                   std::string method, std::string dist_method, std::string path) {
+// writes an hclust object, see dendrogram_file.h
+// labels: NULL, the labels made by point_labels() (saved as the values), or a character vector
+
+  int points_size = order.size();
+  std::int64_t labels_bytes;
+  int labels_saved = labels_kind(labels, labels_bytes);
+
+  try {
+    dendrogram_file file(path, points_size, labels_saved, labels_bytes);
+    std::memcpy(file.merge_left(), merge.begin(), 2 * (points_size - 1) * sizeof(int));
+    std::memcpy(file.height(), height.begin(), (points_size - 1) * sizeof(double));
+    std::memcpy(file.order(), order.begin(), points_size * sizeof(int));
+    write_labels(file, labels);
+    file.finish(method, dist_method);
+  } catch (std::exception & e) {
+    stop(e.what());
+  }
+}
+
+// [[Rcpp::export(.hclust1d_save_points)]]
+void hclust1d_save_points(NumericVector & points, int method, int threads, int queue, bool heap_only, int labels,
+                          SEXP workspace, std::string method_name, std::string dist_method, std::string path) {
+// clusters the points straight to a dendrogram file, see above
+// method: numbered as in hclust1d_heapbased(), and 9 - single
+// threads, queue, heap_only: as in hclust1d_multi(); labels, workspace: as in hclust1d_heapbased()
+
+  int points_size = points.size();
+  RObject saved_labels = point_labels(points, labels);
+  std::int64_t labels_bytes;
+  int labels_saved = labels_kind(saved_labels, labels_bytes);
+
+  try {
+    dendrogram_file file(path, points_size, labels_saved, labels_bytes);
+    std::vector<linkage_dendrogram> linkages(1, {method, file.merge_left(), file.merge_right(), file.height(), NULL});
+    struct hclust1d_workspace temporary;
+    int * order_points = file.order();
+    multi_merges(points.begin(), points_size, linkages, threads, queue, heap_only, workspace_of(workspace, temporary),
+                 order_points);
+
+    for (int i=0; i<points_size; i++)
+      order_points[i]++;    //make it R conformant, in place
+
+    write_labels(file, saved_labels);
+    file.finish(method_name, dist_method);
+  } catch (std::exception & e) {
+    stop(e.what());
+  }
+}
+
+// [[Rcpp::export(.hclust1d_load)]]
+List hclust1d_load(std::string path) {
+// maps a dendrogram file, returns an hclust object of the vectors over it
+
+  dendrogram_file * opened = NULL;
+  try {
+    opened = new dendrogram_file(path);
+  } catch (std::exception & e) {
+    stop(e.what());
+  }
+  XPtr<dendrogram_file> shared(opened, true);
+  dendrogram_file & file = *opened;
+  std::int64_t points_size = file.points_size();
+
+  RObject merge = mapped_vector(mapped_integer_class, shared, file.header.merge_offset, 2 * (points_size - 1));
+  merge.attr("dim") = IntegerVector::create((int) points_size - 1, 2);
+  RObject height = mapped_vector(mapped_real_class, shared, file.header.height_offset, points_size - 1);
+  RObject order_points = mapped_vector(mapped_integer_class, shared, file.header.order_offset, points_size);
+
+  RObject labels;
+  if (file.labels() == string_dendrogram_labels)
+    labels = R_new_altrep(mapped_labels_class, shared, R_NilValue);
+  else if (file.labels() == value_dendrogram_labels) {
+    NumericVector points(mapped_vector(mapped_real_class, shared, file.header.labels_offset, points_size));
+    labels = point_labels(points, value_labels);
+  }
+
+  List ret = List::create(Named("merge")=merge, Named("height")=height, Named("order")=order_points, Named("labels")=labels, Named("method")=std::string(file.header.method), Named("dist.method")=std::string(file.header.dist_method));
+  ret.attr("class") = "hclust";
+  return ret;
+}
@@ -0,0 +1,124 @@
+#include <Rcpp.h>
+#include <vector>  //std::vector
+#include <deque>  //std::deque
+#include <algorithm>  //std::lower_bound, std::min
+#include <cstdint>  //std::int64_t
+#include "hclust1d_dynamic.h"
+
+using namespace Rcpp;
+
+/*
+ *                     a sliding window over a stream of points
+ *
+ * the last size points of a stream, kept in the ordered sets of hclust1d_dynamic.h, with the points
+ * in the order of their arrival in a queue, so that a step of the window inserts the new points and erases
+ * the expired ones, each in O(log size), and nothing gets sorted again
+ *
+ * * a step of at least as many points as there are in the window rebuilds the sets instead (see assign_points)
+ * * as.hclust gives the dendrogram of the points in the window in the order of their arrival, as dynamic_hclust() does
+ * * a step can give the cut memberships of its new points only: the breakpoints of the cut (see breakpoints()) are
+ *   the left points of the intervals not merged, so the cluster of a point is the number of breakpoints before it
+ *   (in the (value, id) order) plus one, found by a binary search; for single linkage that is O(step * log size + k)
+ *   per step, the other linkages rerun the merge loop up to the cut
+ *
+ * ids are given in the order of arrival, counting from the start of the stream (in 64 bits, as a stream may be long),
+ * so the points in the window have consecutive ids
+ *
+ */
+
+struct sliding_window {
+  int method;
+  int size;
+  std::int64_t next_id;
+  std::deque<dynamic_point> arrivals;   //in the window, the oldest first
+  ordered_points sorted;
+};
+
+static sliding_window & window_of(SEXP window) {
+  XPtr<sliding_window> w(window);
+  if (w.get() == NULL)
+    stop("the sliding window is no longer available (was it saved and loaded?)");
+  return *w;
+}
+
+// [[Rcpp::export(.window_create)]]
+SEXP window_create(int size, int method) {
+// methods as in hclust1d_heapbased.cpp, and 9 - single
+
+  sliding_window * w = new sliding_window;
+  w->method = method;
+  w->size = size;
+  w->next_id = 0;
+  return XPtr<sliding_window>(w, true);
+}
+
+// [[Rcpp::export(.window_slide)]]
+IntegerVector window_slide(SEXP window, NumericVector & points, int k = -1, double h = 0.0, int queue = 0) {
+// k: the number of clusters of the cut, 0 for the cut at the height h, -1 for no cut
+// returns the memberships of the new points in the cut (NA for those already expired), or nothing without a cut
+
+  sliding_window & w = window_of(window);
+
+  int step = points.size();
+  //checked before the step, so a step rejected leaves the window as it was
+  if (k > (int)std::min<std::int64_t>(w.size, (std::int64_t)w.arrivals.size() + step))
+    stop("k must not be greater than the number of points in the window");
+
+  bool bulk = step >= (int)w.arrivals.size();
+  for (int i = 0; i < step; i++) {
+    dynamic_point point(points[i], w.next_id++);
+    w.arrivals.push_back(point);
+    if (not bulk)
+      insert_point(w.sorted, point);
+  }
+
+  while ((int)w.arrivals.size() > w.size) {
+    if (not bulk)
+      erase_point(w.sorted, w.arrivals.front());
+    w.arrivals.pop_front();
+  }
+
+  if (bulk)
+    assign_points(w.sorted, std::vector<dynamic_point>(w.arrivals.begin(), w.arrivals.end()));
+
+  if (k < 0)
+    return IntegerVector(0);
+
+  std::vector<dynamic_point> breaks = breakpoints(w.sorted, w.method, k, h, queue);
+  IntegerVector memberships(step);
+  std::int64_t first_id = w.arrivals.front().second;
+  for (int i = 0; i < step; i++) {
+    std::int64_t id = w.next_id - step + i;
+    if (id < first_id)
+      memberships[i] = NA_INTEGER;
+    else
+      memberships[i] = std::lower_bound(breaks.begin(), breaks.end(), dynamic_point(points[i], id)) - breaks.begin() + 1;
+  }
+
+  return memberships;
+}
+
+//in the order of arrival
+static NumericVector window_points(sliding_window & w) {
+  NumericVector ret(w.arrivals.size());
+  for (size_t i = 0; i < w.arrivals.size(); i++)
+    ret[i] = w.arrivals[i].first;
+  return ret;
+}
+
+// [[Rcpp::export(.window_hclust)]]
+List window_hclust(SEXP window, int queue = 0) {
+
+  sliding_window & w = window_of(window);
+
+  int points_size = w.arrivals.size();
+  if (points_size < 2)
+    stop("at least two objects are needed to analyse clusters with hclust1d");
+
+  NumericVector points = window_points(w);
+  std::vector<int> positions(points_size);
+  for (int i = 0; i < points_size; i++)
+    positions[i] = i;
+
+  return ordered_hclust(w.sorted, points, positions, w.arrivals.front().second, w.method, queue);
+}
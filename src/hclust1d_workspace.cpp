@@ -0,0 +1,19 @@
+#include <Rcpp.h>
+#include "hclust1d_workspace.h"
+
+using namespace Rcpp;
+
+struct hclust1d_workspace & workspace_of(SEXP workspace, struct hclust1d_workspace & temporary) {
+  if (Rf_isNull(workspace))
+    return temporary;
+
+  XPtr<struct hclust1d_workspace> w(workspace);
+  if (w.get() == NULL)
+    return temporary;
+  return *w;
+}
+
+// [[Rcpp::export(.hclust1d_workspace)]]
+SEXP hclust1d_workspace_create() {
+  return XPtr<struct hclust1d_workspace>(new struct hclust1d_workspace, true);
+}
@@ -0,0 +1,10 @@
+#ifndef HCLUST1D_WORKSPACE_H
+
+#define HCLUST1D_WORKSPACE_H
+#include <Rcpp.h>
+#include "workspace.h"
+
+//the workspace behind the external pointer, or the temporary one for NULL (or for a pointer gone after saving and loading)
+struct hclust1d_workspace & workspace_of(SEXP workspace, struct hclust1d_workspace & temporary);
+
+#endif
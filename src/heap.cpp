@@ -1,5 +1,5 @@
 #include "heap.h"
-#include <iostream>  //TODO remove with cout
+#include <cstddef>  //NULL
 
 /*
  *                          a custom heap implementation
@@ -10,6 +10,9 @@
  * * ability to heapify both down and up the tree for updating
  *   (both increasing and decreasing) a key in a middle of a tree
  *
+ * the functions changing the heap are templates over the heap type, instantiated for both struct heap
+ * and struct counted_heap; counters() is a constant NULL for the plain heap, so its counting gets compiled out
+ *
  */
 
 //first some housekeeping functions enabling us access on a vector via tree relations
@@ -17,18 +20,29 @@
 int left(int i) { return 2*i+1; }
 int right(int i) { return 2*i+2; }
 int parent(int i) { return (i-1)/2; }
+//the order of nodes: by keys and then by ids (the interval positions),
+//so that of equal keys the leftmost comes first, whatever the shape of the heap
+bool precedes(struct heap & h, int i, int j) {
+  return h.keys[i] < h.keys[j] or (h.keys[i] == h.keys[j] and h.ids[i] < h.ids[j]);
+}
+inline struct heap_counters * counters(struct heap & h) { return NULL; }
+inline struct heap_counters * counters(struct counted_heap & h) { return &h.counters; }
+inline void reset_counters(struct heap & h) {}
+inline void reset_counters(struct counted_heap & h) { h.counters = heap_counters(); }
 //and declarations:
-void switch_node(struct heap & h, int i, int j);
-void heapify_up(struct heap & h, int i);
-void heapify_down(struct heap & h, int i);
+template <class heap_type> void switch_node(heap_type & h, int i, int j);
+template <class heap_type> void heapify_up(heap_type & h, int i);
+template <class heap_type> void heapify_down(heap_type & h, int i);
 
-struct heap init_heap(std::vector<double> keys) {
+template <class heap_type>
+heap_type init_heap_of(std::vector<double> keys) {
   //pass by value the keys because they get assigned and rearanged
   //the ids associated with keys are 0 .. keys.size() - 1
   //please note, that the returned heap may have the ids field rearranged and not in this sequence
 
-  struct heap h;
-  h.keys = keys;
+  heap_type h;
+  reset_counters(h);
+  h.keys = std::move(keys);
   h.ids = std::vector<int>(h.keys.size());
   std::iota(h.ids.begin(), h.ids.end(), 0);
   h.reverse_lookup = std::vector<int>(h.keys.size());
@@ -42,6 +56,50 @@ struct heap init_heap(std::vector<double> keys) {
   return h;
 }
 
+template <class heap_type>
+void init_heap_copied(heap_type & h, const std::vector<double> & keys) {
+  //the same, but the keys are copied into the vectors of h, which keep their capacity
+  reset_counters(h);
+  h.keys.assign(keys.begin(), keys.end());
+  h.ids.resize(h.keys.size());
+  std::iota(h.ids.begin(), h.ids.end(), 0);
+  h.reverse_lookup.resize(h.keys.size());
+  std::iota(h.reverse_lookup.begin(), h.reverse_lookup.end(), 0);
+
+  for (int i = parent(size(h) - 1); i>=0; i--)
+    heapify_down(h, i);
+}
+
+template <class heap_type>
+void init_heap_swapped(heap_type & h, std::vector<double> & keys) {
+  //the same, but the keys are swapped into h instead of copied, and the memory of the old keys is left in keys for reuse
+  reset_counters(h);
+  h.keys.swap(keys);
+  h.ids.resize(h.keys.size());
+  std::iota(h.ids.begin(), h.ids.end(), 0);
+  h.reverse_lookup.resize(h.keys.size());
+  std::iota(h.reverse_lookup.begin(), h.reverse_lookup.end(), 0);
+
+  for (int i = parent(size(h) - 1); i>=0; i--)
+    heapify_down(h, i);
+}
+
+template <class heap_type>
+void init_heap_of_ids(heap_type & h, const std::vector<double> & keys, const std::vector<int> & ids) {
+  //the same, but with the given ids only (and their keys at the ids in keys)
+  reset_counters(h);
+  h.keys.resize(ids.size());
+  h.ids.assign(ids.begin(), ids.end());
+  h.reverse_lookup.resize(keys.size());
+  for (int i = 0; i < (int)ids.size(); i++) {
+    h.keys[i] = keys[ids[i]];
+    h.reverse_lookup[ids[i]] = i;
+  }
+
+  for (int i = parent(size(h) - 1); i>=0; i--)
+    heapify_down(h, i);
+}
+
 int size(struct heap & h) { return h.keys.size(); }
 bool is_empty(struct heap & h) { return size(h) == 0; }
 
@@ -52,7 +110,8 @@ std::pair<double, int> read_minimum(struct heap & h) {
  return std::pair<double, int>(0.0, 0);   //for reading minimum of an empty heap
 }
 
-std::pair<double, int> remove_minimum(struct heap & h) {
+template <class heap_type>
+std::pair<double, int> remove_minimum_of(heap_type & h) {
   std::pair<double, int> r = read_minimum(h);
   if (size(h) <= 1)
     remove_all(h);
@@ -68,7 +127,8 @@ std::pair<double, int> remove_minimum(struct heap & h) {
 
 void remove_all(struct heap & h) { h.keys.clear(); h.ids.clear(); }
 
-int insert(struct heap & h, double key) {
+template <class heap_type>
+int insert_into(heap_type & h, double key) {
   // returning the id of the inserted key
 
   h.keys.push_back(key);                           //push_back is safe reallocation-wise
@@ -85,7 +145,8 @@ double read_key_by_id(struct heap & h, int id) {
   return h.keys[index];
 }
 
-void update_key_by_id(struct heap & h, int id, double new_key) {
+template <class heap_type>
+void update_key_by_id_in(heap_type & h, int id, double new_key) {
   int index = h.reverse_lookup[id];    // this is the spot when we come to need the reverse_lookup array
   h.keys[index] = new_key;
 
@@ -98,18 +159,47 @@ void update_key_by_id(struct heap & h, int id, double new_key) {
 
   heapify_down(h, index);
   heapify_up(h, index);
+
+  struct heap_counters * c = counters(h);
+  if (c != NULL) {
+    c->updates++;
+    if (h.reverse_lookup[id] == index)
+      c->noop_updates++;
+  }
 }
 
+//the instantiations for both heap types
+struct heap init_heap(std::vector<double> keys) { return init_heap_of<struct heap>(std::move(keys)); }
+void init_heap(struct heap & h, const std::vector<double> & keys) { init_heap_copied(h, keys); }
+void init_heap(struct heap & h, std::vector<double> && keys) { init_heap_swapped(h, keys); }
+void init_heap(struct heap & h, const std::vector<double> & keys, const std::vector<int> & ids) { init_heap_of_ids(h, keys, ids); }
+std::pair<double, int> remove_minimum(struct heap & h) { return remove_minimum_of(h); }
+int insert(struct heap & h, double key) { return insert_into(h, key); }
+void update_key_by_id(struct heap & h, int id, double new_key) { update_key_by_id_in(h, id, new_key); }
+
+struct counted_heap init_counted_heap(std::vector<double> keys) { return init_heap_of<struct counted_heap>(std::move(keys)); }
+void init_heap(struct counted_heap & h, const std::vector<double> & keys) { init_heap_copied(h, keys); }
+void init_heap(struct counted_heap & h, std::vector<double> && keys) { init_heap_swapped(h, keys); }
+void init_heap(struct counted_heap & h, const std::vector<double> & keys, const std::vector<int> & ids) { init_heap_of_ids(h, keys, ids); }
+std::pair<double, int> remove_minimum(struct counted_heap & h) { return remove_minimum_of(h); }
+int insert(struct counted_heap & h, double key) { return insert_into(h, key); }
+void update_key_by_id(struct counted_heap & h, int id, double new_key) { update_key_by_id_in(h, id, new_key); }
+
 //////////////////////////////////////////////
 //////////// TECHNICALITIES //////////////////
 //////////////////////////////////////////////
 
-void switch_node(struct heap & h, int i, int j) {
+template <class heap_type>
+void switch_node(heap_type & h, int i, int j) {
           // switches nodes i and j
 
   if (i==j)
     return;
 
+  struct heap_counters * c = counters(h);
+  if (c != NULL)
+    c->switches++;
+
   int id_i = h.ids[i];
   int id_j = h.ids[j];
   double key_i = h.keys[i];
@@ -127,23 +217,28 @@ void switch_node(struct heap & h, int i, int j) {
   h.reverse_lookup[id_j] = i;
 }
 
-void heapify_up(struct heap & h, int i) {
+template <class heap_type>
+void heapify_up(heap_type & h, int i) {
 // the assumption is that i is the proper heap
 // and that the parent of i is smaller than his sons
 // but specifically at i, there may be a problem: i may be smaller than his parent
 // this procedure restores the heap property ( key[parent(i)] <= key[i] ) for the node i and its parent
 
-  if (i > 1) {
+  if (i > 0) {
     int p = parent(i);
 
-    if (h.keys[i] < h.keys[p]) {
+    if (precedes(h, i, p)) {
+      struct heap_counters * c = counters(h);
+      if (c != NULL)
+        c->up_levels++;
       switch_node(h, i, p);
       heapify_up(h, p);
     }
   }
 }
 
-void heapify_down(struct heap & h, int i) {
+template <class heap_type>
+void heapify_down(heap_type & h, int i) {
 // the assumption is that both i's sons are proper heaps
 // this procedure restores the heap property ( key[parent(i)] <= key[i] ) for the node i,
 //    which may be larger than his sons
@@ -154,14 +249,17 @@ void heapify_down(struct heap & h, int i) {
   int minimal = i;
 
   if (l < size(h))
-    if (h.keys[l] < h.keys[minimal])
+    if (precedes(h, l, minimal))
       minimal = l;
 
   if (r < size(h))
-    if (h.keys[r] < h.keys[minimal])
+    if (precedes(h, r, minimal))
       minimal = r;
 
   if (minimal != i) {
+    struct heap_counters * c = counters(h);
+    if (c != NULL)
+      c->down_levels++;
     switch_node(h, i, minimal);
     heapify_down(h, minimal);
   }
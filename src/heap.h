@@ -3,6 +3,7 @@
 #define HEAP_H
 #include <vector>  //std::vector
 #include <numeric> //std::iota
+#include <utility> //std::move
 
 /*
  *                          a custom heap implementation
@@ -13,6 +14,9 @@
  * * ability to heapify both down and up the tree for updating
  *   (both increasing and decreasing) a key in a middle of a tree
  *
+ * counted_heap is the same heap counting its operations, for profiling (see profile.h);
+ * the counting is compiled in for counted_heap only, so the plain heap does not pay for it
+ *
  */
 
 struct heap;
@@ -23,7 +27,23 @@ struct heap {
   std::vector<int> reverse_lookup;
 };
 
+//the counters of a counted_heap, zeroed by init_heap()
+struct heap_counters {
+  unsigned long long switches;   //of nodes, by switch_node()
+  unsigned long long up_levels;   //the levels a node moved up by heapify_up()
+  unsigned long long down_levels;   //the levels a node moved down by heapify_down()
+  unsigned long long updates;   //update_key_by_id() calls
+  unsigned long long noop_updates;   //the updates that left the node in place
+};
+
+struct counted_heap : heap {
+  struct heap_counters counters;
+};
+
 struct heap init_heap(std::vector<double> keys);
+void init_heap(struct heap & h, const std::vector<double> & keys);   //reusing the memory of h
+void init_heap(struct heap & h, std::vector<double> && keys);   //the same, but swapping the keys in (and the old keys of h out)
+void init_heap(struct heap & h, const std::vector<double> & keys, const std::vector<int> & ids);   //the given ids only
 
 int size(struct heap & h);
 bool is_empty(struct heap & h);
@@ -37,4 +57,14 @@ int insert(struct heap & h, double key);
 double read_key_by_id(struct heap & h, int id);
 void update_key_by_id(struct heap & h, int id, double new_key);
 
+//the same for a counted_heap (the functions reading the heap only are shared with the plain heap)
+struct counted_heap init_counted_heap(std::vector<double> keys);
+void init_heap(struct counted_heap & h, const std::vector<double> & keys);
+void init_heap(struct counted_heap & h, std::vector<double> && keys);
+void init_heap(struct counted_heap & h, const std::vector<double> & keys, const std::vector<int> & ids);
+
+std::pair<double, int> remove_minimum(struct counted_heap & h);
+int insert(struct counted_heap & h, double key);
+void update_key_by_id(struct counted_heap & h, int id, double new_key);
+
 #endif
@@ -0,0 +1,211 @@
+#ifndef HEAPBASED_H
+
+#define HEAPBASED_H
+#include <vector>  //std::vector
+#include <utility>  //std::pair, std::move
+#include <cmath>  //std::isfinite
+#include "order.h"
+#include "priority_queue.h"
+#include "linkage.h"
+#include "profile.h"
+
+/*
+ *                     the heap-based merge loop on raw arrays
+ *
+ * heapbased_merges() reads points_size points and writes the (0-based) order of the points to the array given
+ * (of length points_size), using no R objects, for a given linkage (see linkage.h) and a given priority queue backend
+ * (see priority_queue.h), and passes each merge to a sink:
+ *
+ * * sink(stage, id, height, left_merge, right_merge) - the interval id merged at the stage,
+ *   returning whether to go on with the next stage
+ *
+ * dendrogram_sink writes the merge columns and the heights to the arrays given, of lengths points_size - 1,
+ * other sinks can stop the loop early (see hclust1d_cut.cpp)
+ *
+ * an interval of two equal points (a duplicate) has the key 0, the smallest possible one, so the duplicates
+ * get merged first, in the order of their positions (the ties of keys are resolved by ids). merge_duplicates() replays
+ * the merges of the keys 0 on the keys kept in an array, without the queue, for as long as that order is certain:
+ * each interval left behind must have a key above 0 (which the rounding of centroids may break). The queue gets only
+ * the intervals left, so for data with many duplicates it holds about as many keys as there are unique values,
+ * and the merges are the same as without the replay
+ *
+ * heapbased_merges_sorted() does the same for the (0-based) order of the points and the points in that order already known
+ * (as shared by the linkages clustered together in multi.cpp), with no sorting
+ *
+ * the wall time of its phases is added to the profile given, if any (see profile.h)
+ *
+ * the workspace holds all the buffers of the loop, and reusing it over many calls
+ * (as in hclust1d_batch.cpp) allocates only when a call needs more memory than any call before
+ *
+ */
+
+template <class linkage, class queue>
+struct heapbased_workspace {
+  std::vector<double> sorted_points;
+  std::vector<double> distances;
+  std::vector<int> ids;   //of the intervals left after the duplicates
+  struct order_workspace sorting;
+  typename linkage::state s;
+  queue priority_queue;
+
+  heapbased_workspace() : s(sorted_points) {}
+  heapbased_workspace(const heapbased_workspace &) = delete;  //s refers to sorted_points
+};
+
+struct dendrogram_sink {
+  int * merge_left;
+  int * merge_right;
+  double * height;
+
+  inline bool operator()(int stage, int id, double key, int left_merge, int right_merge) {
+    merge_left[stage] = left_merge;
+    merge_right[stage] = right_merge;
+    height[stage] = key;
+    return true;
+  }
+};
+
+//the updates of the state and the keys after merging the interval id at the stage
+template <class linkage, class queue>
+inline void merge_interval(typename linkage::state & s, queue & priority_queue, int id, int stage, int points_size) {
+  typename linkage::interval & interval = s.at[id];
+  int left_id = interval.left_start - 1;
+            // in C++: -1 means "no id to the left"
+  int right_id = interval.right_end < points_size - 1 ? interval.right_end : -1;
+            // in C++: -1 means "no id to the right"
+
+  struct merged_cluster m;  //calculate statistics of the currently merged cluster
+  linkage::merged(s, id, m);
+
+  if (left_id > -1) {
+      s.at[left_id].right_end = interval.right_end;
+      s.at[left_id].right_merge = stage + 1;
+
+      linkage::update_left(s, priority_queue, id, left_id, m);
+    }
+
+  if (right_id > -1) {
+      s.at[right_id].left_start = interval.left_start;
+      s.at[right_id].left_merge = stage + 1;
+
+      linkage::update_right(s, priority_queue, id, right_id, m);
+    }
+}
+
+//returns the number of stages merged, and whether the sink stopped the loop
+template <class linkage, class sink>
+int merge_duplicates(typename linkage::state & s, std::vector<double> & keys, std::vector<int> & ids, int points_size,
+                     sink & merges, bool & stopped) {
+  struct key_array q = {keys};
+  int stage = 0;
+  //all the intervals left behind (in ids) have keys above 0, and none of the keys is a NaN (so infinite points are left to the queue)
+  bool replaying = std::isfinite(s.points.front()) and std::isfinite(s.points.back());
+
+  ids.clear();
+  for (int id = 0; id < points_size - 1; id++) {
+    if (not replaying or keys[id] != 0.0) {
+      if (not (keys[id] > 0.0))
+        replaying = false;
+      ids.push_back(id);
+      continue;
+    }
+
+    //the interval id has the smallest id of the keys 0, and so has the interval to its left once its key turns 0
+    for (int next = id; next > -1; ) {
+      if (not merges(stage, next, keys[next], s.at[next].left_merge, s.at[next].right_merge)) {
+        stopped = true;
+        return stage;
+      }
+
+      merge_interval<linkage>(s, q, next, stage, points_size);
+      stage++;
+
+      int left_id = s.at[next].left_start - 1;
+      int right_id = s.at[next].right_end < points_size - 1 ? s.at[next].right_end : -1;
+      if ((left_id > -1 and not (keys[left_id] >= 0.0)) or (right_id > -1 and not (keys[right_id] >= 0.0))) {
+        replaying = false;
+        break;
+      }
+
+      next = -1;
+      if (left_id > -1 and keys[left_id] == 0.0) {
+        ids.pop_back();   //the interval to the left is the last one left behind
+        next = left_id;
+      }
+    }
+  }
+
+  stopped = false;
+  return stage;
+}
+
+template <class linkage, class queue, class sink>
+void heapbased_merges_sorted(const int * order_points, const double * sorted_points, int points_size,
+                             heapbased_workspace<linkage, queue> & w, sink & merges, struct profile * p = NULL) {
+
+  if (sorted_points != w.sorted_points.data())
+    w.sorted_points.assign(sorted_points, sorted_points + points_size);
+
+  //the state of the intervals (there are points_size - 1 intervals)
+  //the interval i lies between the sorted points i and i + 1
+  typename linkage::state & s = w.s;
+  s.at.resize(points_size - 1);
+
+  std::vector<double> & distances = w.distances;
+  distances.resize(points_size - 1);
+  for (int i = 0; i < points_size - 1; i++) {
+    s.at[i].left_start = i;
+    s.at[i].right_end = i + 1;
+    s.at[i].left_merge = -order_points[i] - 1;
+    s.at[i].right_merge = -order_points[i + 1] - 1;
+    linkage::init(s, i);
+
+    //the sequence of distances within intervals
+    distances[i] = linkage::initial_distance(sorted_points[i + 1] - sorted_points[i]);
+  }
+  profile_lap(p, gaps_phase);
+
+  bool stopped;
+  int stage = merge_duplicates<linkage>(s, distances, w.ids, points_size, merges, stopped);
+  profile_lap(p, merges_phase);
+  if (stopped)
+    return;
+
+  queue & priority_queue = w.priority_queue;
+  if (stage == 0)
+    init_queue(priority_queue, std::move(distances));   //not needed any more
+  else
+    init_queue(priority_queue, distances, w.ids);
+  profile_lap(p, queue_phase);
+
+  for (; stage < points_size - 1; stage++) {
+
+    std::pair<double, int> key_id = remove_minimum(priority_queue);
+    int id = key_id.second;
+    //the cluster number id is being merged
+
+    if (not merges(stage, id, key_id.first, s.at[id].left_merge, s.at[id].right_merge))
+      break;
+
+    merge_interval<linkage>(s, priority_queue, id, stage, points_size);
+  }
+  profile_lap(p, merges_phase);
+  profile_counters(p, priority_queue);
+}
+
+template <class linkage, class queue, class sink>
+void heapbased_merges(const double * points, int points_size, heapbased_workspace<linkage, queue> & w,
+                      int * order_points, sink & merges, struct profile * p = NULL) {
+
+  order(points, points_size, order_points, 1, w.sorting);
+  profile_lap(p, sort_phase);
+
+  std::vector<double> & sorted_points = w.sorted_points;
+  sorted_points.resize(points_size);
+  for (int i = 0; i < points_size; i++)
+    sorted_points[i] = points[order_points[i]];
+
+  heapbased_merges_sorted(order_points, sorted_points.data(), points_size, w, merges, p);
+}
+
+#endif
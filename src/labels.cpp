@@ -0,0 +1,75 @@
+#include <Rcpp.h>
+#include <R_ext/Altrep.h>
+#include "labels.h"
+
+using namespace Rcpp;
+
+// the ALTREP class of the labels: data1 holds the points, data2 holds all the labels once formatted (or NULL)
+
+static R_altrep_class_t point_labels_class;
+
+static R_xlen_t point_labels_length(SEXP x) {
+  return XLENGTH(R_altrep_data1(x));
+}
+
+static SEXP point_labels_formatted(SEXP x) {
+  SEXP labels = R_altrep_data2(x);
+  if (labels == R_NilValue) {
+    labels = Rf_coerceVector(R_altrep_data1(x), STRSXP);
+    R_set_altrep_data2(x, labels);
+  }
+  return labels;
+}
+
+static void * point_labels_dataptr(SEXP x, Rboolean writeable) {
+  return (void *) STRING_PTR_RO(point_labels_formatted(x));
+}
+
+static const void * point_labels_dataptr_or_null(SEXP x) {
+  SEXP labels = R_altrep_data2(x);
+  return labels == R_NilValue ? NULL : (const void *) STRING_PTR_RO(labels);
+}
+
+static SEXP point_labels_elt(SEXP x, R_xlen_t i) {
+  SEXP labels = R_altrep_data2(x);
+  if (labels != R_NilValue)
+    return STRING_ELT(labels, i);
+
+  //the same formatting as for the whole vector, see coerceVector() in R
+  SEXP point = PROTECT(Rf_ScalarReal(REAL_ELT(R_altrep_data1(x), i)));
+  SEXP label = STRING_ELT(Rf_coerceVector(point, STRSXP), 0);
+  UNPROTECT(1);
+  return label;
+}
+
+static void point_labels_set_elt(SEXP x, R_xlen_t i, SEXP label) {
+  SET_STRING_ELT(point_labels_formatted(x), i, label);
+}
+
+// [[Rcpp::init]]
+void init_point_labels(DllInfo * dll) {
+  point_labels_class = R_make_altstring_class("point_labels", "hclust1d", dll);
+  R_set_altrep_Length_method(point_labels_class, point_labels_length);
+  R_set_altvec_Dataptr_method(point_labels_class, point_labels_dataptr);
+  R_set_altvec_Dataptr_or_null_method(point_labels_class, point_labels_dataptr_or_null);
+  R_set_altstring_Elt_method(point_labels_class, point_labels_elt);
+  R_set_altstring_Set_elt_method(point_labels_class, point_labels_set_elt);
+}
+
+SEXP point_labels(NumericVector & points, int labels) {
+  if (labels == no_labels)
+    return R_NilValue;
+
+  if (labels == auto_labels and points.attr("names") != R_NilValue)
+    return points.names();
+
+  //the points are shared with the labels from now on, so a change of either copies them first
+  MARK_NOT_MUTABLE((SEXP) points);
+  return R_new_altrep(point_labels_class, points, R_NilValue);
+}
+
+SEXP labelled_points(SEXP labels) {
+  if (ALTREP(labels) and R_altrep_inherits(labels, point_labels_class))
+    return R_altrep_data1(labels);
+  return R_NilValue;
+}
@@ -0,0 +1,34 @@
+#ifndef LABELS_H
+
+#define LABELS_H
+
+#include <Rcpp.h>
+using namespace Rcpp;
+
+/*
+ *                     the labels of the points in a dendrogram
+ *
+ * the labels of unnamed points are the points converted to strings, as in as.character(), which for many points
+ * formats and caches as many strings (taking more time and memory than the clustering itself), so they are
+ * an ALTREP string vector holding the points, formatting a label only when it is read.
+ * All the labels get formatted at once only when R asks for the whole vector in memory, and are kept from then on
+ *
+ * * auto_labels - the names of the points, or the points converted to strings for unnamed points
+ * * no_labels - NULL
+ * * value_labels - the points converted to strings, even for named points
+ *
+ */
+
+//the numbering is shared with R, see hclust1d.R
+enum labels_choice {
+  auto_labels = 0,
+  no_labels = 1,
+  value_labels = 2
+};
+
+SEXP point_labels(NumericVector & points, int labels);
+
+//the points of the labels made by point_labels(), or NULL for any other labels
+SEXP labelled_points(SEXP labels);
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef LINKAGE_H
+
+#define LINKAGE_H
+
+#include <vector>  //std::vector
+#include <cmath>  //std::sqrt
+#include "cache_line_allocator.h"
+
+/*
+ *                     linkage policies for the heap-based merge loop
+ *
+ * each linkage is a struct with static member functions only, it is a template parameter
+ * of the merge loop in hclust1d_heapbased.cpp, so that the method is resolved at compile time
+ * (one instantiation of the loop per linkage) instead of being switched on at each stage
+ *
+ * a linkage provides:
+ *
+ * * interval - a record of the state of one interval, holding only the fields the linkage needs
+ * * initial_distance(distance) - the key of an interval of two singletons
+ * * init(state, i) - the linkage specific fields of an interval of two singletons
+ * * merged(state, id, merged) - the statistics of the cluster being merged at the interval id
+ * * update_left(state, queue, id, left_id, merged) - the update of the interval to the left of id
+ * * update_right(state, queue, id, right_id, merged) - the update of the interval to the right of id
+ *
+ * the updates are templates over the priority queue backend, see priority_queue.h
+ *
+ */
+
+//the keys of the intervals kept in an array, with the same update_key_by_id() as in the priority queues,
+//for the merges done without a queue (in hclust1d_nnchain.cpp and in merge_duplicates() in heapbased.h)
+struct key_array {
+  std::vector<double> & keys;
+};
+
+inline void update_key_by_id(struct key_array & k, int id, double new_key) { k.keys[id] = new_key; }
+
+//the fields shared by all the linkages
+//
+//the intervals are numbered by the position of their left point in the sorted order
+//(there are points_size - 1 intervals, the interval i lies between the sorted points i and i + 1)
+//each interval (which is a possible merge opportunity)
+//               constitutes of 2 clusters - the left one and the right one
+//at the beginning they are both just the singletons
+//
+//as the clusters are always contiguous in the sorted order,
+//the left cluster of the interval i spans the sorted points from left_start to i
+//and the right one spans the sorted points from i + 1 to right_end
+//so neither the cluster counts nor the neighbouring intervals need to be stored:
+//the interval to the left is left_start - 1 and the interval to the right is right_end
+struct interval_base {
+  int left_start;
+  int right_end;
+  int left_merge;
+  int right_merge;
+};
+
+template <class interval>
+struct intervals {
+  std::vector<double> & points;  //sorted
+  std::vector<interval, cache_line_allocator<interval> > at;
+
+  intervals(std::vector<double> & points) : points(points), at(points.empty() ? 0 : points.size() - 1) {}
+
+  inline int left_count(int i) { return i - at[i].left_start + 1; }
+  inline int right_count(int i) { return at[i].right_end - i; }
+
+  double median(int leftmost_index, int cluster_count) {
+    int midpoint_index = leftmost_index + cluster_count / 2;
+    if (cluster_count % 2 == 1)
+      return points[midpoint_index];
+    return (points[midpoint_index - 1] + points[midpoint_index])/2.0;
+  }
+};
+
+//statistics of the currently merged cluster, each linkage fills only what it needs
+struct merged_cluster {
+  int cluster_count;
+  double centroid_aggregate;
+  double rightish_weighted_distance_sums;
+  double leftish_weighted_distance_sums;
+};
+
+struct single_linkage {  //single_implemented_by_heap linkage
+  struct alignas(16) interval : interval_base {};
+  typedef intervals<interval> state;
+
+  static inline double initial_distance(double distance) { return distance; }
+
+  static inline void init(state & s, int i) {}
+
+  static inline void merged(state & s, int id, merged_cluster & m) {}
+
+  template <class queue>
+  static inline void update_left(state & s, queue & q, int id, int left_id, merged_cluster & m) {}
+
+  template <class queue>
+  static inline void update_right(state & s, queue & q, int id, int right_id, merged_cluster & m) {}
+};
+
+struct complete_linkage {
+  struct alignas(16) interval : interval_base {};
+  typedef intervals<interval> state;
+
+  static inline double initial_distance(double distance) { return distance; }
+
+  static inline void init(state & s, int i) {}
+
+  static inline void merged(state & s, int id, merged_cluster & m) {}
+
+  template <class queue>
+  static inline void update_left(state & s, queue & q, int id, int left_id, merged_cluster & m) {
+    update_key_by_id(q, left_id,
+                     s.points[s.at[id].right_end] -
+                     s.points[s.at[left_id].left_start]);
+  }
+
+  template <class queue>
+  static inline void update_right(state & s, queue & q, int id, int right_id, merged_cluster & m) {
+    update_key_by_id(q, right_id,
+                     s.points[s.at[right_id].right_end] -
+                     s.points[s.at[id].left_start]);
+  }
+};
+
+struct average_linkage {  //UPGMA
+  struct alignas(16) interval : interval_base {
+    double left_part_leftish_weighted_distance_sums;
+    double left_part_rightish_weighted_distance_sums;
+    double right_part_leftish_weighted_distance_sums;
+    double right_part_rightish_weighted_distance_sums;
+  };
+  typedef intervals<interval> state;
+
+  static inline double initial_distance(double distance) { return distance; }
+
+  static inline void init(state & s, int i) {
+    s.at[i].left_part_leftish_weighted_distance_sums = 0.0;
+    s.at[i].left_part_rightish_weighted_distance_sums = 0.0;
+    s.at[i].right_part_leftish_weighted_distance_sums = 0.0;
+    s.at[i].right_part_rightish_weighted_distance_sums = 0.0;
+  }
+
+  static inline void merged(state & s, int id, merged_cluster & m) {
+    interval & r = s.at[id];
+    m.cluster_count = s.left_count(id) + s.right_count(id);
+    m.rightish_weighted_distance_sums = r.left_part_rightish_weighted_distance_sums +
+                                        r.right_part_rightish_weighted_distance_sums +
+                                        s.left_count(id) *
+                                        (s.points[r.right_end] - s.points[id]);
+    m.leftish_weighted_distance_sums = r.left_part_leftish_weighted_distance_sums +
+                                       r.right_part_leftish_weighted_distance_sums +
+                                       s.right_count(id) *
+                                       (s.points[id + 1] - s.points[r.left_start]);
+  }
+
+  template <class queue>
+  static inline void update_left(state & s, queue & q, int id, int left_id, merged_cluster & m) {
+    //id cluster just got merged
+    interval & l = s.at[left_id];
+    update_key_by_id(q, left_id,
+                     l.left_part_rightish_weighted_distance_sums / s.left_count(left_id) +
+                     m.leftish_weighted_distance_sums / m.cluster_count +
+                     s.points[s.at[id].left_start] - s.points[left_id]);
+
+    l.right_part_leftish_weighted_distance_sums = m.leftish_weighted_distance_sums;
+    l.right_part_rightish_weighted_distance_sums = m.rightish_weighted_distance_sums;
+  }
+
+  template <class queue>
+  static inline void update_right(state & s, queue & q, int id, int right_id, merged_cluster & m) {
+    interval & r = s.at[right_id];
+    update_key_by_id(q, right_id,
+                     m.rightish_weighted_distance_sums / m.cluster_count +
+                     r.right_part_leftish_weighted_distance_sums / s.right_count(right_id) +
+                     s.points[right_id + 1] - s.points[s.at[id].right_end]);
+
+    r.left_part_leftish_weighted_distance_sums = m.leftish_weighted_distance_sums;
+    r.left_part_rightish_weighted_distance_sums = m.rightish_weighted_distance_sums;
+  }
+};
+
+//centroid (UPGMC), ward.D (mult) and ward.D2 (mult and sqrt) share the same update
+//centroid works on a squared euclidean distance in theory, but for 1d it makes no difference
+template <bool mult, bool sqrt, bool squared>
+struct centroid_family_linkage {
+  struct alignas(32) interval : interval_base {
+    double left_centroid_aggregate;
+    double right_centroid_aggregate;
+  };
+  typedef intervals<interval> state;
+
+  static inline double initial_distance(double distance) {
+    if (squared)
+      return distance * distance;  //centroid and ward.D return a squared euclidean distance
+    return distance;
+  }
+
+  static inline void init(state & s, int i) {
+    s.at[i].left_centroid_aggregate = s.points[i];
+    s.at[i].right_centroid_aggregate = s.points[i + 1];
+  }
+
+  static inline void merged(state & s, int id, merged_cluster & m) {
+    m.cluster_count = s.left_count(id) + s.right_count(id);
+    m.centroid_aggregate = s.at[id].left_centroid_aggregate + s.at[id].right_centroid_aggregate;
+  }
+
+  static inline double distance(double first_centroid, double second_centroid, int other_count, int id_count) {
+    double distance = first_centroid - second_centroid;
+
+    distance = distance * distance;
+
+    if (mult)
+      distance = 2.0 * distance *
+                 ((double)other_count * id_count) /   //in doubles, as the product of the counts overflows an int past 46340 squared
+                 (other_count + id_count);
+    if (sqrt)
+      distance = std::sqrt(distance);
+
+    return distance;
+  }
+
+  template <class queue>
+  static inline void update_left(state & s, queue & q, int id, int left_id, merged_cluster & m) {
+    interval & l = s.at[left_id];
+    double distance = centroid_family_linkage::distance(m.centroid_aggregate / m.cluster_count,
+                                                        l.left_centroid_aggregate / s.left_count(left_id),
+                                                        s.left_count(left_id), m.cluster_count);
+
+    update_key_by_id(q, left_id, distance); //centroid, ward.D returns a squared euclidean distance
+    l.right_centroid_aggregate = m.centroid_aggregate;
+  }
+
+  template <class queue>
+  static inline void update_right(state & s, queue & q, int id, int right_id, merged_cluster & m) {
+    interval & r = s.at[right_id];
+    double distance = centroid_family_linkage::distance(r.right_centroid_aggregate / s.right_count(right_id),
+                                                        m.centroid_aggregate / m.cluster_count,
+                                                        s.right_count(right_id), m.cluster_count);
+
+    update_key_by_id(q, right_id, distance); //centroid, ward.D returns a squared euclidean distance
+    r.left_centroid_aggregate = m.centroid_aggregate;
+  }
+};
+
+typedef centroid_family_linkage<false, false, true> centroid_linkage;  //UPGMC
+typedef centroid_family_linkage<true, false, true> ward_D_linkage;
+typedef centroid_family_linkage<true, true, false> ward_D2_linkage;
+
+struct true_median_linkage {
+  struct alignas(16) interval : interval_base {};
+  typedef intervals<interval> state;
+
+  static inline double initial_distance(double distance) { return distance; }
+
+  static inline void init(state & s, int i) {}
+
+  static inline void merged(state & s, int id, merged_cluster & m) {
+    m.cluster_count = s.left_count(id) + s.right_count(id);
+  }
+
+  template <class queue>
+  static inline void update_left(state & s, queue & q, int id, int left_id, merged_cluster & m) {
+    //id cluster just got merged
+    double distance = s.median(s.at[id].left_start,
+                               m.cluster_count) -
+                      s.median(s.at[left_id].left_start,
+                               s.left_count(left_id));
+    update_key_by_id(q, left_id, distance);
+  }
+
+  template <class queue>
+  static inline void update_right(state & s, queue & q, int id, int right_id, merged_cluster & m) {
+    //id cluster just got merged
+    double distance = s.median(right_id + 1,
+                               s.right_count(right_id)) -
+                      s.median(s.at[id].left_start,
+                               m.cluster_count);
+    update_key_by_id(q, right_id, distance);
+  }
+};
+
+struct median_linkage {  //median aka weighted centroids (WPGMC)
+  struct alignas(32) interval : interval_base {
+    double left_centroid_aggregate;
+    double right_centroid_aggregate;
+  };
+  typedef intervals<interval> state;
+
+  static inline double initial_distance(double distance) {
+    return distance * distance;  //median (=weighted centroid) returns a squared euclidean distance
+  }
+
+  static inline void init(state & s, int i) {
+    s.at[i].left_centroid_aggregate = s.points[i];
+    s.at[i].right_centroid_aggregate = s.points[i + 1];
+  }
+
+  static inline void merged(state & s, int id, merged_cluster & m) {
+    m.centroid_aggregate = (s.at[id].left_centroid_aggregate + s.at[id].right_centroid_aggregate)/2.0;
+  }
+
+  template <class queue>
+  static inline void update_left(state & s, queue & q, int id, int left_id, merged_cluster & m) {
+    double distance = m.centroid_aggregate - s.at[left_id].left_centroid_aggregate;
+    update_key_by_id(q, left_id, distance * distance); //median returns a squared euclidean distance
+    s.at[left_id].right_centroid_aggregate = m.centroid_aggregate;
+  }
+
+  template <class queue>
+  static inline void update_right(state & s, queue & q, int id, int right_id, merged_cluster & m) {
+    double distance = s.at[right_id].right_centroid_aggregate - m.centroid_aggregate;
+    update_key_by_id(q, right_id, distance * distance);  //median returns a squared euclidean distance
+    s.at[right_id].left_centroid_aggregate = m.centroid_aggregate;
+  }
+};
+
+struct mcquitty_linkage {  //WPGMA
+  struct alignas(16) interval : interval_base {
+    double left_part_leftish_weighted_distance_sums;
+    double left_part_rightish_weighted_distance_sums;
+    double right_part_leftish_weighted_distance_sums;
+    double right_part_rightish_weighted_distance_sums;
+  };
+  typedef intervals<interval> state;
+
+  static inline double initial_distance(double distance) { return distance; }
+
+  static inline void init(state & s, int i) {
+    s.at[i].left_part_leftish_weighted_distance_sums = 0.0;
+    s.at[i].left_part_rightish_weighted_distance_sums = 0.0;
+    s.at[i].right_part_leftish_weighted_distance_sums = 0.0;
+    s.at[i].right_part_rightish_weighted_distance_sums = 0.0;
+  }
+
+  static inline void merged(state & s, int id, merged_cluster & m) {
+    interval & r = s.at[id];
+    m.rightish_weighted_distance_sums = 0.5 * r.left_part_rightish_weighted_distance_sums +
+                                        0.5 * r.right_part_rightish_weighted_distance_sums +
+                                        s.points[r.right_end] - s.points[id];
+    m.leftish_weighted_distance_sums = 0.5 * r.left_part_leftish_weighted_distance_sums +
+                                       0.5 * r.right_part_leftish_weighted_distance_sums +
+                                       s.points[id + 1] - s.points[r.left_start];
+  }
+
+  template <class queue>
+  static inline void update_left(state & s, queue & q, int id, int left_id, merged_cluster & m) {
+    //id cluster just got merged
+    interval & l = s.at[left_id];
+    update_key_by_id(q, left_id,
+                     0.5 * l.left_part_rightish_weighted_distance_sums +
+                     0.5 * m.leftish_weighted_distance_sums +
+                     s.points[s.at[id].left_start] - s.points[left_id]);
+
+    l.right_part_leftish_weighted_distance_sums = m.leftish_weighted_distance_sums;
+    l.right_part_rightish_weighted_distance_sums = m.rightish_weighted_distance_sums;
+  }
+
+  template <class queue>
+  static inline void update_right(state & s, queue & q, int id, int right_id, merged_cluster & m) {
+    interval & r = s.at[right_id];
+    update_key_by_id(q, right_id,
+                     0.5 * m.rightish_weighted_distance_sums +
+                     0.5 * r.right_part_leftish_weighted_distance_sums +
+                     s.points[right_id + 1] - s.points[s.at[id].right_end]);
+
+    r.left_part_leftish_weighted_distance_sums = m.leftish_weighted_distance_sums;
+    r.left_part_rightish_weighted_distance_sums = m.rightish_weighted_distance_sums;
+  }
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include <vector>  //std::vector
+#include <functional>  //std::function
+#include <algorithm>  //std::max
+#include <stdexcept>  //std::invalid_argument
+#include "multi.h"
+#include "heapbased.h"
+#include "nnchain.h"
+#include "single.h"
+#include "parallel.h"
+
+//the order and the sorted points shared by the loops, read only
+struct shared_sort {
+  const int * order_points;
+  const double * sorted_points;
+  int points_size;
+};
+
+//a merge loop with its workspace already taken, called with the threads it may use
+typedef std::function<void(int)> linkage_job;
+
+template <class linkage, class queue>
+static linkage_job heapbased_job(const shared_sort & sorted, linkage_dendrogram & d, struct hclust1d_workspace & workspace) {
+  heapbased_workspace<linkage, queue> & w = reused<heapbased_workspace<linkage, queue> >(workspace);
+  return [&sorted, &d, &w](int threads) {
+    dendrogram_sink merges = {d.merge_left, d.merge_right, d.height};
+    heapbased_merges_sorted(sorted.order_points, sorted.sorted_points, sorted.points_size, w, merges, d.p);
+  };
+}
+
+template <class linkage>
+static linkage_job heapbased_job(const shared_sort & sorted, linkage_dendrogram & d, int queue,
+                                 struct hclust1d_workspace & workspace) {
+  switch (queue) {
+  case binary_heap_backend:
+    if (d.p != NULL)
+      return heapbased_job<linkage, struct counted_heap>(sorted, d, workspace);
+    return heapbased_job<linkage, struct heap>(sorted, d, workspace);
+  case quaternary_heap_backend:
+    return heapbased_job<linkage, struct quaternary_heap>(sorted, d, workspace);
+  case tournament_tree_backend:
+    return heapbased_job<linkage, struct tournament_tree>(sorted, d, workspace);
+  }
+
+  throw std::invalid_argument("unsupported priority queue backend");
+}
+
+template <class linkage>
+static linkage_job reducible_job(const shared_sort & sorted, linkage_dendrogram & d, int queue, bool heap_only,
+                                 struct hclust1d_workspace & workspace) {
+  if (heap_only)
+    return heapbased_job<linkage>(sorted, d, queue, workspace);
+
+  nnchain_workspace<linkage> & w = reused<nnchain_workspace<linkage> >(workspace);
+  return [&sorted, &d, &w](int threads) {
+    nnchain_merges_sorted(sorted.order_points, sorted.sorted_points, sorted.points_size, threads, w,
+                          d.merge_left, d.merge_right, d.height, d.p);
+  };
+}
+
+static linkage_job single_job(const shared_sort & sorted, linkage_dendrogram & d, struct hclust1d_workspace & workspace) {
+  struct single_workspace & w = reused<struct single_workspace>(workspace);
+  return [&sorted, &d, &w](int threads) {
+    single_merges_sorted(sorted.order_points, sorted.sorted_points, sorted.points_size, threads, w,
+                         d.merge_left, d.merge_right, d.height, d.p);
+  };
+}
+
+static linkage_job job(const shared_sort & sorted, linkage_dendrogram & d, int queue, bool heap_only,
+                       struct hclust1d_workspace & workspace) {
+  switch (d.method) {
+  case 0:
+    return heapbased_job<single_linkage>(sorted, d, queue, workspace);
+  case 1:
+    return reducible_job<complete_linkage>(sorted, d, queue, heap_only, workspace);
+  case 2:
+    return reducible_job<average_linkage>(sorted, d, queue, heap_only, workspace);
+  case 3:
+    return heapbased_job<centroid_linkage>(sorted, d, queue, workspace);
+  case 4:
+    return heapbased_job<true_median_linkage>(sorted, d, queue, workspace);
+  case 5:
+    return heapbased_job<median_linkage>(sorted, d, queue, workspace);
+  case 6:
+    return reducible_job<mcquitty_linkage>(sorted, d, queue, heap_only, workspace);
+  case 7:
+    return reducible_job<ward_D_linkage>(sorted, d, queue, heap_only, workspace);
+  case 8:
+    return reducible_job<ward_D2_linkage>(sorted, d, queue, heap_only, workspace);
+  case 9:
+    return single_job(sorted, d, workspace);
+  }
+
+  throw std::invalid_argument("unsupported linkage method");
+}
+
+void linkage_merges_sorted(const int * order_points, const double * sorted_points, int points_size, linkage_dendrogram & d,
+                           int threads, int queue, bool heap_only, struct hclust1d_workspace & workspace) {
+  shared_sort sorted = {order_points, sorted_points, points_size};
+  job(sorted, d, queue, heap_only, workspace)(threads);
+}
+
+void multi_merges(const double * points, int points_size, std::vector<linkage_dendrogram> & linkages, int threads,
+                  int queue, bool heap_only, struct hclust1d_workspace & workspace, int * order_points) {
+
+  int linkages_size = linkages.size();
+  bool profiled = false;
+  for (int l = 0; l < linkages_size; l++) {
+    for (int other = 0; other < l; other++)
+      if (linkages[other].method == linkages[l].method)
+        throw std::invalid_argument("a linkage method is given more than once");
+    profiled = profiled or linkages[l].p != NULL;
+  }
+
+  //all the workspaces taken on this thread, as the map of the workspace is not thread safe
+  struct multi_workspace & w = reused<struct multi_workspace>(workspace);
+  shared_sort sorted = {order_points, NULL, points_size};
+  std::vector<linkage_job> jobs;
+  for (int l = 0; l < linkages_size; l++)
+    jobs.push_back(job(sorted, linkages[l], queue, heap_only, workspace));
+
+  struct profile sorting;
+  struct profile * p = profiled ? &sorting : NULL;
+  profile_start(p);
+
+  order(points, points_size, order_points, threads, w.sorting);
+  std::vector<double> & sorted_points = w.sorted_points;
+  sorted_points.resize(points_size);
+  for (int i = 0; i < points_size; i++)
+    sorted_points[i] = points[order_points[i]];
+  sorted.sorted_points = sorted_points.data();
+  profile_lap(p, sort_phase);
+
+  int job_threads = std::max(1, threads / linkages_size);
+  parallel_items(linkages_size, threads, [&](int worker, int l) {
+    struct profile * linkage_p = linkages[l].p;
+    profile_start(linkage_p);
+    if (linkage_p != NULL)
+      linkage_p->seconds[sort_phase] = sorting.seconds[sort_phase];
+    jobs[l](job_threads);
+  }, 1);
+}
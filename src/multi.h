@@ -0,0 +1,55 @@
+#ifndef MULTI_H
+
+#define MULTI_H
+#include <vector>  //std::vector
+#include "order.h"
+#include "profile.h"
+#include "workspace.h"
+
+/*
+ *                     several linkages over a single sort
+ *
+ * comparing linkages on the same points would repeat the sort of the points, the gaps and the setup
+ * of the intervals for each of them, so multi_merges() sorts the points once (on threads), and the merge loops
+ * of all the linkages given start from that order and the points in that order (see heapbased_merges_sorted()
+ * in heapbased.h, nnchain_merges_sorted() in nnchain.h and single_merges_sorted() in single.h), read only,
+ * each loop on its own thread (see parallel_items() in parallel.h)
+ *
+ * * each linkage is clustered by the same loop as when clustered alone: single linkage by its own loop,
+ *   the reducible linkages by the nearest-neighbour chain (unless heap_only), and the others by the heap-based loop
+ *   with the queue backend given (see priority_queue.h), so the results are the same
+ * * the threads beyond one per linkage are split evenly among the loops, for the loops using threads (see hclust1d.R)
+ * * the workspaces of the loops are taken from the workspace given before any thread starts, one per linkage,
+ *   so a linkage must not be given twice
+ *
+ * throws std::invalid_argument for a repeated or unsupported linkage, or an unsupported queue backend,
+ * before clustering anything
+ *
+ * the profile of each linkage (if any) gets the time of the shared sort, followed by the time of its own phases
+ *
+ */
+
+struct linkage_dendrogram {
+  int method;   //numbered as in hclust1d_heapbased.cpp, and 9 - single
+  int * merge_left;
+  int * merge_right;
+  double * height;
+  struct profile * p;   //or NULL
+};
+
+struct multi_workspace {
+  std::vector<double> sorted_points;
+  struct order_workspace sorting;
+};
+
+//the merges and the heights of a single linkage, for the (0-based) order of the points and the points in that order
+//already known, by the same loop as in multi_merges(), on this thread (and the threads given, for the loops using them);
+//a workspace must not be used by two calls at the same time (see bootstrap.cpp)
+void linkage_merges_sorted(const int * order_points, const double * sorted_points, int points_size, linkage_dendrogram & d,
+                           int threads, int queue, bool heap_only, struct hclust1d_workspace & workspace);
+
+//writes the (0-based) order of the points, and the merges and the heights of each linkage
+void multi_merges(const double * points, int points_size, std::vector<linkage_dendrogram> & linkages, int threads,
+                  int queue, bool heap_only, struct hclust1d_workspace & workspace, int * order_points);
+
+#endif
@@ -0,0 +1,357 @@
+#ifndef NNCHAIN_H
+
+#define NNCHAIN_H
+#include <vector>  //std::vector
+#include <algorithm>  //std::push_heap, std::pop_heap
+#include <numeric>  //std::iota
+#include "order.h"
+#include "linkage.h"
+#include "parallel.h"
+#include "profile.h"
+
+/*
+ *                 the nearest-neighbour-chain engine for reducible linkages
+ *
+ * in 1d each cluster has at most two merge candidates: its left and its right neighbour,
+ * so an interval whose key is not larger than the keys of both neighbouring intervals
+ * constitutes of two mutual nearest neighbours. For reducible linkages (complete, average,
+ * mcquitty, ward.D, ward.D2 and single) they can be merged right away, without changing the dendrogram.
+ *
+ * The chain is a stack of intervals with decreasing keys, walking towards a local minimum.
+ * There is no priority queue: each interval gets pushed a constant number of times on average,
+ * so the merges are found in linear time after the sort.
+ *
+ * The merges are found in a different order than in the heap-based merge loop,
+ * so finally they get re-sorted by height (and by the interval id for ties, as in the priority queues)
+ * and renumbered, so that merge and height are the same as in hclust1d_heapbased()
+ *
+ * On many threads (and for long input) the chain is preceded by rounds: all the local minima
+ * (the intervals of mutual nearest neighbours) get found and merged at once, each round in parallel chunks
+ * (see parallel.h), and the intervals left are compacted for the next round. Two local minima are never
+ * neighbours, so a round merges independent intervals, and the keys of their neighbours are updated
+ * (the right neighbours first, then the left ones) exactly as the sequential chain updates them.
+ * The rounds stop when few minima are left in a round (as for presorted points with increasing gaps),
+ * and the chain finishes the merges. The merges are re-sorted anyway, so the result does not depend
+ * on the number of threads.
+ *
+ * nnchain_merges() works on raw arrays, as heapbased_merges() does (see heapbased.h), using no R objects,
+ * and nnchain_merges_sorted() starts from the points already sorted, as heapbased_merges_sorted() does;
+ * the wall time of its phases is added to the profile given, if any (see profile.h)
+ *
+ * the workspace holds all the buffers of the chain and of the re-sorting, see workspace.h for reusing it over calls
+ *
+ */
+
+template <class linkage>
+struct nnchain_workspace {
+  std::vector<double> sorted_points;
+  typename linkage::state s;
+  std::vector<double> keys;
+  std::vector<double> merged_heights;
+  std::vector<int> merged_left;
+  std::vector<int> merged_right;
+  std::vector<char> alive;
+  std::vector<int> chain;
+  std::vector<int> round_ids;   //the intervals left, in their order
+  std::vector<int> next_round_ids;
+  std::vector<char> minimum;   //by the position in round_ids
+  std::vector<int> chunk_minima;
+  std::vector<merged_cluster> merged_clusters;   //by the merged interval
+  std::vector<int> sorted_merges;
+  std::vector<int> parents;
+  std::vector<char> pending_children;
+  std::vector<int> ready;   //a heap of the merges ready to output
+  std::vector<char> waiting;
+  std::vector<int> stages;
+  struct order_workspace sorting;
+
+  nnchain_workspace() : s(sorted_points) {}
+  nnchain_workspace(const nnchain_workspace &) = delete;  //s refers to sorted_points
+};
+
+//a round of fewer minima than that fraction of the intervals left does not pay for its passes over them
+const int nnchain_round_minima_fraction = 8;
+
+//the merges of all the local minima at once, round after round, with the merges filled in and alive cleared
+//for the merged intervals; returns the number of the merges done
+template <class linkage>
+int nnchain_rounds(typename linkage::state & s, struct key_array & k, int points_size, int threads,
+                   nnchain_workspace<linkage> & w) {
+  std::vector<int> & ids = w.round_ids;
+  std::vector<int> & next_ids = w.next_round_ids;
+  std::vector<char> & minimum = w.minimum;
+  std::vector<int> & chunk_minima = w.chunk_minima;
+  std::vector<merged_cluster> & merged_clusters = w.merged_clusters;
+  ids.resize(points_size - 1);
+  std::iota(ids.begin(), ids.end(), 0);
+  merged_clusters.resize(points_size - 1);
+
+  auto precedes = [&](int a, int b) {
+    return k.keys[a] < k.keys[b] or (k.keys[a] == k.keys[b] and a < b);
+  };
+
+  int merged = 0;
+  for (;;) {
+    int size = ids.size();
+    int chunks = chunks_count(size, threads);
+    if (chunks < 2)
+      break;
+
+    minimum.resize(size);
+    chunk_minima.assign(chunks, 0);
+    parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+      int minima = 0;
+      for (int j = begin; j < end; j++) {
+        int id = ids[j];
+        minimum[j] = (j == 0 or precedes(id, ids[j - 1])) and (j == size - 1 or precedes(id, ids[j + 1]));
+        minima += minimum[j];
+      }
+      chunk_minima[chunk] = minima;
+    });
+
+    int minima = 0;
+    for (int chunk = 0; chunk < chunks; chunk++)
+      minima += chunk_minima[chunk];
+    if (minima < size / nnchain_round_minima_fraction)
+      break;
+
+    //the merges and the updates of the right neighbours
+    parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+      for (int j = begin; j < end; j++) {
+        if (!minimum[j])
+          continue;
+        int id = ids[j];
+        typename linkage::interval & interval = s.at[id];
+        w.alive[id] = 0;
+        w.merged_heights[id] = k.keys[id];
+        w.merged_left[id] = interval.left_merge;
+        w.merged_right[id] = interval.right_merge;
+        linkage::merged(s, id, merged_clusters[id]);
+
+        if (j < size - 1) {
+          int right_id = ids[j + 1];
+          s.at[right_id].left_start = interval.left_start;
+          s.at[right_id].left_merge = id + 1;
+
+          linkage::update_right(s, k, id, right_id, merged_clusters[id]);
+        }
+      }
+    });
+
+    //the updates of the left neighbours, after the right ones, as in the chain going from left to right
+    parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+      for (int j = std::max(begin, 1); j < end; j++) {
+        if (!minimum[j])
+          continue;
+        int id = ids[j];
+        int left_id = ids[j - 1];
+        s.at[left_id].right_end = s.at[id].right_end;
+        s.at[left_id].right_merge = id + 1;
+
+        linkage::update_left(s, k, id, left_id, merged_clusters[id]);
+      }
+    });
+
+    //the intervals left, each chunk compacted to its offset
+    next_ids.resize(size - minima);
+    parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+      int next = begin;
+      for (int previous = 0; previous < chunk; previous++)
+        next -= chunk_minima[previous];
+      for (int j = begin; j < end; j++)
+        if (!minimum[j])
+          next_ids[next++] = ids[j];
+    });
+    ids.swap(next_ids);
+    merged += minima;
+  }
+
+  return merged;
+}
+
+template <class linkage>
+void nnchain_merges_sorted(const int * order_points, const double * sorted_points, int points_size, int threads,
+                           nnchain_workspace<linkage> & w, int * merge_left, int * merge_right, double * height,
+                           struct profile * p = NULL) {
+
+  if (sorted_points != w.sorted_points.data())
+    w.sorted_points.assign(sorted_points, sorted_points + points_size);
+
+  //the state of the intervals (there are points_size - 1 intervals)
+  //the interval i lies between the sorted points i and i + 1
+  //unlike in the heap-based merge loop, left_merge and right_merge hold the id + 1 of an interval
+  //which merged the left (or the right) cluster, or a negative singleton label, as usual
+  typename linkage::state & s = w.s;
+  s.at.resize(points_size - 1);
+  std::vector<double> & keys = w.keys;
+  keys.resize(points_size - 1);
+  struct key_array k = {keys};
+
+  for (int i = 0; i < points_size - 1; i++) {
+    s.at[i].left_start = i;
+    s.at[i].right_end = i + 1;
+    s.at[i].left_merge = -order_points[i] - 1;
+    s.at[i].right_merge = -order_points[i + 1] - 1;
+    linkage::init(s, i);
+
+    k.keys[i] = linkage::initial_distance(sorted_points[i + 1] - sorted_points[i]);
+  }
+  profile_lap(p, gaps_phase);
+
+  //the order of intervals: by keys and then by ids, as in the priority queues
+  auto precedes = [&](int a, int b) {
+    return k.keys[a] < k.keys[b] or (k.keys[a] == k.keys[b] and a < b);
+  };
+
+  //the merges, indexed by the merged interval
+  std::vector<double> & merged_heights = w.merged_heights;
+  std::vector<int> & merged_left = w.merged_left;
+  std::vector<int> & merged_right = w.merged_right;
+  merged_heights.resize(points_size - 1);
+  merged_left.resize(points_size - 1);
+  merged_right.resize(points_size - 1);
+
+  std::vector<char> & alive = w.alive;
+  alive.assign(points_size - 1, 1);
+  std::vector<int> & chain = w.chain;
+  chain.clear();
+  int first_alive = 0;
+
+  int merged = threads > 1 ? nnchain_rounds<linkage>(s, k, points_size, threads, w) : 0;
+  while (merged < points_size - 1) {
+
+    if (chain.empty()) {
+      while (!alive[first_alive])
+        first_alive++;
+      chain.push_back(first_alive);
+    }
+
+    int id = chain.back();
+    int left_id = s.at[id].left_start - 1;
+              // in C++: -1 means "no id to the left"
+    int right_id = s.at[id].right_end < points_size - 1 ? s.at[id].right_end : -1;
+              // in C++: -1 means "no id to the right"
+
+    int nearest = id;
+    if (left_id > -1 and precedes(left_id, nearest))
+      nearest = left_id;
+    if (right_id > -1 and precedes(right_id, nearest))
+      nearest = right_id;
+
+    if (nearest != id) {
+      if (chain.size() > 1 and nearest == chain[chain.size() - 2])
+        chain.pop_back();    //the previous interval got closer after a merge, the chain walks back
+      else
+        chain.push_back(nearest);
+      continue;
+    }
+
+    //the cluster number id is being merged, its neighbours are farther apart
+    chain.pop_back();
+    alive[id] = 0;
+    merged++;
+
+    typename linkage::interval & interval = s.at[id];
+    merged_heights[id] = k.keys[id];
+    merged_left[id] = interval.left_merge;
+    merged_right[id] = interval.right_merge;
+
+    struct merged_cluster m;  //calculate statistics of the currently merged cluster
+    linkage::merged(s, id, m);
+
+    if (left_id > -1) {
+        s.at[left_id].right_end = interval.right_end;
+        s.at[left_id].right_merge = id + 1;
+
+        linkage::update_left(s, k, id, left_id, m);
+      }
+
+    if (right_id > -1) {
+        s.at[right_id].left_start = interval.left_start;
+        s.at[right_id].left_merge = id + 1;
+
+        linkage::update_right(s, k, id, right_id, m);
+      }
+  }
+
+  //the merges sorted by height, ties resolved by the interval id (the sort is stable)
+  std::vector<int> & sorted_merges = w.sorted_merges;
+  sorted_merges.resize(points_size - 1);
+  order(merged_heights.data(), points_size - 1, sorted_merges.data(), threads, w.sorting);
+
+  //a merge can be output after its (at most two) child merges only.
+  //If a child merge comes later in the sorted order (it can happen for ties of heights,
+  //or if rounding makes the linkage not quite reducible), the merge waits for it.
+  //Of the merges ready to output, the one preceding in the sorted order goes first,
+  //which is exactly what the heap-based merge loop does
+  std::vector<int> & parents = w.parents;
+  std::vector<char> & pending_children = w.pending_children;
+  parents.assign(points_size - 1, -1);
+  pending_children.assign(points_size - 1, 0);
+  for (int i = 0; i < points_size - 1; i++) {
+    if (merged_left[i] > 0) {
+      parents[merged_left[i] - 1] = i;
+      pending_children[i]++;
+    }
+    if (merged_right[i] > 0) {
+      parents[merged_right[i] - 1] = i;
+      pending_children[i]++;
+    }
+  }
+
+  auto follows = [&](const int & a, const int & b) {
+    return merged_heights[b] < merged_heights[a] or (merged_heights[b] == merged_heights[a] and b < a);
+  };
+  std::vector<int> & ready = w.ready;   //with the top at the front, as in std::priority_queue
+  ready.clear();
+  std::vector<char> & waiting = w.waiting;
+  waiting.assign(points_size - 1, 0);
+  std::vector<int> & stages = w.stages;
+  stages.resize(points_size - 1);
+
+  int next = 0;
+  for (int stage = 0; stage < points_size - 1; ) {
+    int id;
+    if (!ready.empty() and (next == points_size - 1 or follows(sorted_merges[next], ready.front()))) {
+      id = ready.front();
+      std::pop_heap(ready.begin(), ready.end(), follows);
+      ready.pop_back();
+    } else {
+      id = sorted_merges[next++];
+      if (pending_children[id] > 0) {
+        waiting[id] = 1;
+        continue;
+      }
+    }
+
+    stages[id] = stage;
+    merge_left[stage] = merged_left[id] > 0 ? stages[merged_left[id] - 1] + 1 : merged_left[id];
+    merge_right[stage] = merged_right[id] > 0 ? stages[merged_right[id] - 1] + 1 : merged_right[id];
+    height[stage] = merged_heights[id];
+    stage++;
+
+    int parent = parents[id];
+    if (parent > -1 and --pending_children[parent] == 0 and waiting[parent]) {
+      ready.push_back(parent);
+      std::push_heap(ready.begin(), ready.end(), follows);
+    }
+  }
+  profile_lap(p, merges_phase);
+}
+
+template <class linkage>
+void nnchain_merges(const double * points, int points_size, int threads, nnchain_workspace<linkage> & w,
+                    int * order_points, int * merge_left, int * merge_right, double * height, struct profile * p = NULL) {
+
+  order(points, points_size, order_points, threads, w.sorting);
+  profile_lap(p, sort_phase);
+
+  std::vector<double> & sorted_points = w.sorted_points;
+  sorted_points.resize(points_size);
+  for (int i = 0; i < points_size; i++)
+    sorted_points[i] = points[order_points[i]];
+
+  nnchain_merges_sorted(order_points, sorted_points.data(), points_size, threads, w, merge_left, merge_right, height, p);
+}
+
+#endif
@@ -1,17 +1,183 @@
-#include <Rcpp.h>
 #include <vector>
-using namespace Rcpp;
+#include <algorithm>  //std::sort, std::find, std::fill, std::max
+#include <numeric>  //std::iota
+#include <cstring>  //std::memcpy
+#include "order.h"
+#include "parallel.h"
 
-void order(NumericVector & data, std::vector<int> & index) {
-  //https://stackoverflow.com/questions/17554242/how-to-obtain-the-index-permutation-after-the-sorting
+namespace {
 
+const int radix_bits = 11;
+const int radix_size = 1 << radix_bits;
+const int radix_threshold = 256;   //shorter data is sorted with a comparison sort
 
-  std::iota(index.begin(), index.end(), 0);
-  sort(index.begin(), index.end(),
-       [&](const int& a, const int& b) {
-         return (data[a] < data[b]);
-       }
-  );
+inline std::uint64_t radix_key(double d) {
+  if (d == 0.0)
+    d = 0.0;   //-0.0 and 0.0 are equal, as in comparisons
+  std::uint64_t bits;
+  std::memcpy(&bits, &d, sizeof(bits));
+  //negative numbers have all the bits flipped (so that they sort in the reverse order),
+  //non-negative numbers have the sign bit flipped (so that they sort after the negative ones)
+  if (bits & 0x8000000000000000ULL)
+    return ~bits;
+  return bits | 0x8000000000000000ULL;
 }
 
+inline std::uint64_t radix_key(int i) {
+  return static_cast<std::uint32_t>(i) ^ 0x80000000U;
+}
+
+typedef order_keyed_index keyed_index;
+
+template <typename T>
+bool presorted(const T * data, int size, int * index, int chunks) {
+  //non-decreasing data is already in order
+  //strictly decreasing data is in order when reversed (no ties, so the reversal keeps the sort stable)
+  std::vector<char> ascending(chunks, true);
+  std::vector<char> descending(chunks, true);
+  parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+    bool chunk_ascending = true;
+    bool chunk_descending = true;
+    for (int i = std::max(begin, 1); i < end and (chunk_ascending or chunk_descending); i++) {
+      if (data[i] < data[i-1])
+        chunk_ascending = false;
+      else
+        chunk_descending = false;
+    }
+    ascending[chunk] = chunk_ascending;
+    descending[chunk] = chunk_descending;
+  });
+
+  bool all_ascending = std::find(ascending.begin(), ascending.end(), false) == ascending.end();
+  bool all_descending = std::find(descending.begin(), descending.end(), false) == descending.end();
+
+  if (all_ascending or all_descending)
+    parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+      for (int i = begin; i < end; i++)
+        index[i] = all_ascending ? i : size - 1 - i;
+    });
+
+  return all_ascending or all_descending;
+}
+
+template <typename T>
+void radix_order(const T * data, int size, int * index, int key_bits, int chunks, struct order_workspace & w) {
+  int passes = (key_bits + radix_bits - 1) / radix_bits;
+
+  std::vector<keyed_index> & from = w.from;
+  std::vector<keyed_index> & to = w.to;
+  from.resize(size);
+  to.resize(size);
+
+  //all the histograms of all the chunks are counted in a single pass over the data,
+  //they remain valid for the next passes with a single chunk only,
+  //otherwise the chunks are recounted after each pass
+  std::vector<int> & counts = w.counts;
+  counts.assign(chunks * passes * radix_size, 0);
+  parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+    int * count = &counts[chunk * passes * radix_size];
+    for (int i = begin; i < end; i++) {
+      from[i].key = radix_key(data[i]);
+      from[i].index = i;
+      for (int pass = 0; pass < passes; pass++)
+        count[pass * radix_size + ((from[i].key >> (pass * radix_bits)) & (radix_size - 1))]++;
+    }
+  });
+
+  for (int pass = 0; pass < passes; pass++) {
+    int shift = pass * radix_bits;
+
+    int first_digit = (from[0].key >> shift) & (radix_size - 1);
+    int first_digit_count = 0;
+    for (int chunk = 0; chunk < chunks; chunk++)
+      first_digit_count += counts[(chunk * passes + pass) * radix_size + first_digit];
+    if (first_digit_count == size)
+      continue;   //all the keys share this digit, nothing to do
+
+    if (pass > 0 and chunks > 1)
+      parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+        int * count = &counts[(chunk * passes + pass) * radix_size];
+        std::fill(count, count + radix_size, 0);
+        for (int i = begin; i < end; i++)
+          count[(from[i].key >> shift) & (radix_size - 1)]++;
+      });
+
+    //the chunks keep their order within each digit, so the sort stays stable
+    int offset = 0;
+    for (int digit = 0; digit < radix_size; digit++)
+      for (int chunk = 0; chunk < chunks; chunk++) {
+        int & count = counts[(chunk * passes + pass) * radix_size + digit];
+        int c = count;
+        count = offset;
+        offset += c;
+      }
+
+    parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+      int * count = &counts[(chunk * passes + pass) * radix_size];
+      for (int i = begin; i < end; i++)
+        to[count[(from[i].key >> shift) & (radix_size - 1)]++] = from[i];
+    });
+    from.swap(to);
+  }
+
+  parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+    for (int i = begin; i < end; i++)
+      index[i] = from[i].index;
+  });
+}
+
+template <typename T>
+void adaptive_order(const T * data, int size, int * index, int key_bits, int threads, struct order_workspace & w) {
+  int chunks = chunks_count(size, threads);
 
+  if (presorted(data, size, index, chunks))
+    return;
+
+  if (size < radix_threshold) {
+    //the keys paired with their indices sort stably with an unstable sort, in a buffer on the stack
+    //(short data comes in large numbers in batches, see hclust1d_batch.cpp, and should allocate nothing)
+    keyed_index keyed[radix_threshold];
+    for (int i = 0; i < size; i++) {
+      keyed[i].key = radix_key(data[i]);
+      keyed[i].index = i;
+    }
+    std::sort(keyed, keyed + size,
+              [](const keyed_index & a, const keyed_index & b) {
+                return a.key < b.key or (a.key == b.key and a.index < b.index);
+              }
+    );
+    for (int i = 0; i < size; i++)
+      index[i] = keyed[i].index;
+    return;
+  }
+
+  radix_order(data, size, index, key_bits, chunks, w);
+}
+
+}
+
+void order(const double * data, int size, int * index, int threads) {
+  struct order_workspace w;
+  adaptive_order(data, size, index, 64, threads, w);
+}
+
+void order(const int * data, int size, int * index, int threads) {
+  struct order_workspace w;
+  adaptive_order(data, size, index, 32, threads, w);
+}
+
+void order(const double * data, int size, int * index, int threads, struct order_workspace & w) {
+  adaptive_order(data, size, index, 64, threads, w);
+}
+
+void order(const int * data, int size, int * index, int threads, struct order_workspace & w) {
+  adaptive_order(data, size, index, 32, threads, w);
+}
+
+void order(std::vector<double> & data, std::vector<int> & index) {
+  order(data.data(), data.size(), index.data());
+}
+
+void order(std::vector<int> & data, std::vector<int> & index) {
+  order(data.data(), data.size(), index.data());
+}
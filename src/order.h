@@ -2,23 +2,45 @@
 
 #define ORDER_H
 
-#include <Rcpp.h>
 #include <vector>
-using namespace Rcpp;
+#include <cstdint>  //std::uint64_t
 
-void order(NumericVector & data, std::vector<int> & index);
+/*
+ *                     an adaptive argsort
+ *
+ * the index is filled with a permutation sorting the data in an increasing order,
+ * with ties kept in the order of their indices (the sort is stable)
+ *
+ * * already sorted (non-decreasing) and reverse sorted (strictly decreasing) data is detected
+ *   in a single pass and not sorted at all
+ * * short data is sorted with a comparison sort of the keys paired with their indices
+ * * otherwise it is an LSD radix sort of the data keys paired with their indices,
+ *   for doubles the keys are IEEE bit patterns flipped to sort as unsigned integers
+ * * with threads > 1, long data is split into chunks, each histogrammed and scattered on its own thread,
+ *   giving the same permutation as a single thread
+ *
+ * the radix sort buffers are allocated at each call, unless a workspace is given:
+ * reusing it over many calls allocates only when a call needs more memory than any call before
+ *
+ */
 
-template <typename T>
-void order(std::vector<T> & data, std::vector<int> & index) {
-  //https://stackoverflow.com/questions/17554242/how-to-obtain-the-index-permutation-after-the-sorting
+struct order_keyed_index {
+  std::uint64_t key;
+  int index;
+};
 
+struct order_workspace {
+  std::vector<order_keyed_index> from;
+  std::vector<order_keyed_index> to;
+  std::vector<int> counts;
+};
 
-  std::iota(index.begin(), index.end(), 0);
-  sort(index.begin(), index.end(),
-       [&](const int& a, const int& b) {
-         return (data[a] < data[b]);
-       }
-  );
-}
+void order(const double * data, int size, int * index, int threads = 1);
+void order(const int * data, int size, int * index, int threads = 1);
+void order(const double * data, int size, int * index, int threads, struct order_workspace & w);
+void order(const int * data, int size, int * index, int threads, struct order_workspace & w);
+
+void order(std::vector<double> & data, std::vector<int> & index);
+void order(std::vector<int> & data, std::vector<int> & index);
 
 #endif
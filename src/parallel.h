@@ -0,0 +1,100 @@
+#ifndef PARALLEL_H
+
+#define PARALLEL_H
+
+#include <thread>  //std::thread
+#include <vector>  //std::vector
+#include <system_error>  //std::system_error
+#include <algorithm>  //std::min, std::max
+#include <atomic>  //std::atomic
+#include <mutex>  //std::mutex, std::lock_guard
+#include <exception>  //std::exception_ptr
+
+/*
+ *                     a fork-join loop over chunks
+ *
+ * the range 0 .. size - 1 is split into chunks of (almost) equal lengths,
+ * and f(chunk, begin, end) is called for each chunk, each on its own thread
+ * (chunk 0 on the calling thread), and all of them are joined before returning
+ *
+ * * there is at most one chunk per parallel_grain elements, so short data is processed in a single chunk,
+ *   on the calling thread only, without starting any threads
+ * * f must not call R and must not throw (allocate its memory before the fork)
+ * * if a thread cannot be started, its chunk is processed on the calling thread
+ *
+ * for many independent items of varying cost (as in hclust1d_batch.cpp) there is parallel_items,
+ * calling f(worker, item) for each item, with the items handed out in blocks to whichever worker is free
+ * (blocks of a single item for a few long items, as in multi.cpp), and the worker (0 .. threads - 1)
+ * identifying its own memory to reuse;
+ * an exception thrown by f stops handing out the items and gets rethrown on the calling thread
+ *
+ */
+
+const int parallel_grain = 1 << 15;
+
+inline int chunks_count(int size, int threads) {
+  return std::max(1, std::min(threads, size / parallel_grain));
+}
+
+inline int chunk_begin(int size, int chunks, int chunk) {
+  return (int)((long long)size * chunk / chunks);
+}
+
+template <class F>
+void parallel_chunks(int size, int chunks, F f) {
+  std::vector<std::thread> workers;
+  int started = 1;
+  try {
+    for (; started < chunks; started++)
+      workers.emplace_back(f, started, chunk_begin(size, chunks, started), chunk_begin(size, chunks, started + 1));
+  } catch (std::system_error &) {
+    //no more threads available, the remaining chunks are processed below
+  }
+
+  f(0, 0, chunk_begin(size, chunks, 1));
+  for (int chunk = started; chunk < chunks; chunk++)
+    f(chunk, chunk_begin(size, chunks, chunk), chunk_begin(size, chunks, chunk + 1));
+
+  for (auto & worker: workers)
+    worker.join();
+}
+
+const int parallel_items_block = 16;
+
+template <class F>
+void parallel_items(int items, int threads, F f, int block = parallel_items_block) {
+  std::atomic<int> next(0);
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto work = [&](int worker) {
+    try {
+      for (int first = next.fetch_add(block); first < items; first = next.fetch_add(block))
+        for (int item = first; item < std::min(items, first + block); item++)
+          f(worker, item);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (not error)
+        error = std::current_exception();
+      next = items;
+    }
+  };
+
+  int workers = std::max(1, std::min(threads, (items + block - 1) / block));
+  std::vector<std::thread> started;
+  try {
+    for (int worker = 1; worker < workers; worker++)
+      started.emplace_back(work, worker);
+  } catch (std::system_error &) {
+    //no more threads available, the ones started and the calling thread process all the items
+  }
+
+  work(0);
+  for (auto & worker: started)
+    worker.join();
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef PRIORITY_QUEUE_H
+
+#define PRIORITY_QUEUE_H
+#include <vector>  //std::vector
+#include <utility> //std::move
+#include "heap.h"
+#include "quaternary_heap.h"
+#include "tournament_tree.h"
+
+/*
+ *                     priority queue backends of the merge loop
+ *
+ * each backend is a struct with the same set of functions:
+ *
+ * * init_queue<backend>(keys) - a queue with the ids 0 .. keys.size() - 1
+ * * init_queue(q, keys) - the same, but reusing the memory of the queue q
+ * * init_queue(q, std::move(keys)) - the same, but the keys no longer needed by the caller,
+ *   so the binary heap takes them over instead of copying them (the other backends pack keys into nodes anyway)
+ * * init_queue(q, keys, ids) - the same, but with the given (increasing) ids only, and their keys at the ids in keys
+ * * size(q), is_empty(q)
+ * * read_minimum(q), remove_minimum(q) - a (key, id) pair
+ * * read_key_by_id(q, id), update_key_by_id(q, id, new_key)
+ *
+ * all of them resolve ties of keys by ids (the smaller id goes first),
+ * so the merge loop gives the same results whichever backend is used
+ *
+ * the keys are doubles in all the backends, and are not narrowed to floats (or to integers for integer data):
+ * the merge loop is bound by the latency of its scattered accesses to the intervals and the queue, not by their size,
+ * so 4 bytes keys (8 bytes nodes in quaternary_heap) bring no measurable speedup, while rounded keys
+ * would change the ties, and so the merges, and the heights returned
+ *
+ * the backend is an internal knob, chosen in R with options(hclust1d.priority_queue = ...)
+ *
+ * counted_heap is the binary heap counting its operations, used instead of it when a profile is asked for (see profile.h)
+ */
+
+//the numbering is shared with R, see hclust1d.R
+enum priority_queue_backend {
+  binary_heap_backend = 0,
+  quaternary_heap_backend = 1,
+  tournament_tree_backend = 2
+};
+
+template <class queue>
+queue init_queue(std::vector<double> keys);
+
+template <>
+inline struct heap init_queue<struct heap>(std::vector<double> keys) {
+  return init_heap(std::move(keys));
+}
+
+template <>
+inline struct counted_heap init_queue<struct counted_heap>(std::vector<double> keys) {
+  return init_counted_heap(std::move(keys));
+}
+
+template <>
+inline struct quaternary_heap init_queue<struct quaternary_heap>(std::vector<double> keys) {
+  return init_quaternary_heap(std::move(keys));
+}
+
+template <>
+inline struct tournament_tree init_queue<struct tournament_tree>(std::vector<double> keys) {
+  return init_tournament_tree(std::move(keys));
+}
+
+inline void init_queue(struct heap & q, const std::vector<double> & keys) {
+  init_heap(q, keys);
+}
+
+inline void init_queue(struct counted_heap & q, const std::vector<double> & keys) {
+  init_heap(q, keys);
+}
+
+inline void init_queue(struct quaternary_heap & q, const std::vector<double> & keys) {
+  init_quaternary_heap(q, keys);
+}
+
+inline void init_queue(struct tournament_tree & q, const std::vector<double> & keys) {
+  init_tournament_tree(q, keys);
+}
+
+inline void init_queue(struct heap & q, std::vector<double> && keys) {
+  init_heap(q, std::move(keys));
+}
+
+inline void init_queue(struct counted_heap & q, std::vector<double> && keys) {
+  init_heap(q, std::move(keys));
+}
+
+inline void init_queue(struct quaternary_heap & q, std::vector<double> && keys) {
+  init_quaternary_heap(q, keys);
+}
+
+inline void init_queue(struct tournament_tree & q, std::vector<double> && keys) {
+  init_tournament_tree(q, keys);
+}
+
+inline void init_queue(struct heap & q, const std::vector<double> & keys, const std::vector<int> & ids) {
+  init_heap(q, keys, ids);
+}
+
+inline void init_queue(struct counted_heap & q, const std::vector<double> & keys, const std::vector<int> & ids) {
+  init_heap(q, keys, ids);
+}
+
+inline void init_queue(struct quaternary_heap & q, const std::vector<double> & keys, const std::vector<int> & ids) {
+  init_quaternary_heap(q, keys, ids);
+}
+
+inline void init_queue(struct tournament_tree & q, const std::vector<double> & keys, const std::vector<int> & ids) {
+  init_tournament_tree(q, keys, ids);
+}
+
+#endif
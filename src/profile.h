@@ -0,0 +1,92 @@
+#ifndef PROFILE_H
+
+#define PROFILE_H
+#include <chrono>  //std::chrono::steady_clock
+#include <vector>  //std::vector
+#include "heap.h"
+
+/*
+ *                     wall time of the phases of a clustering
+ *
+ * the merge loops take a pointer to a profile, NULL unless asked for, and call profile_lap() at the end of each phase,
+ * which adds the time elapsed since the previous lap to that phase (a NULL profile costs a single comparison per phase)
+ *
+ * * sort_phase - sorting the points
+ * * gaps_phase - the distances between consecutive sorted points and the initial state of the intervals
+ * * queue_phase - building the priority queue (the heap-based loop) or sorting the distances (single linkage)
+ * * merges_phase - the merges themselves (including the duplicates replayed, see heapbased.h,
+ *   and the re-sorting of the merges of the nearest-neighbour chain)
+ * * output_phase - building the R result
+ *
+ * with a profile asked for, the heap-based merge loop runs a counted_heap instead of the binary heap (see heap.h),
+ * and its counters get copied into the profile at the end of the loop; the other backends and merge loops count nothing
+ *
+ */
+
+//the numbering is shared with R, see hclust1d.R
+enum profile_phase {
+  sort_phase = 0,
+  gaps_phase = 1,
+  queue_phase = 2,
+  merges_phase = 3,
+  output_phase = 4,
+  profile_phases = 5
+};
+
+struct profile {
+  std::chrono::steady_clock::time_point lap_start;
+  double seconds[profile_phases];
+  bool counted;
+  struct heap_counters counters;
+};
+
+inline void profile_start(struct profile * p) {
+  if (p == NULL)
+    return;
+  for (int phase = 0; phase < profile_phases; phase++)
+    p->seconds[phase] = 0.0;
+  p->counted = false;
+  p->lap_start = std::chrono::steady_clock::now();
+}
+
+inline void profile_lap(struct profile * p, int phase) {
+  if (p == NULL)
+    return;
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  p->seconds[phase] += std::chrono::duration<double>(now - p->lap_start).count();
+  p->lap_start = now;
+}
+
+//the next lap starts now, leaving out the time since the previous one (spent waiting for other loops, see multi.cpp)
+inline void profile_skip(struct profile * p) {
+  if (p == NULL)
+    return;
+  p->lap_start = std::chrono::steady_clock::now();
+}
+
+template <class queue>
+inline void profile_counters(struct profile * p, queue & q) {
+  //the queue counts nothing
+}
+
+inline void profile_counters(struct profile * p, struct counted_heap & q) {
+  if (p == NULL)
+    return;
+  p->counted = true;
+  p->counters = q.counters;
+}
+
+//the seconds of the phases, followed by the counters of the heap, if counted (in the order of struct heap_counters)
+inline std::vector<double> profile_values(const struct profile & p) {
+  std::vector<double> values(p.seconds, p.seconds + profile_phases);
+  if (p.counted) {
+    values.push_back(p.counters.switches);
+    values.push_back(p.counters.up_levels);
+    values.push_back(p.counters.down_levels);
+    values.push_back(p.counters.updates);
+    values.push_back(p.counters.noop_updates);
+  }
+  return values;
+}
+
+#endif
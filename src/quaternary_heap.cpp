@@ -0,0 +1,145 @@
+#include "quaternary_heap.h"
+#include <algorithm>  //std::min
+
+/*
+ *                     an iterative 4-ary heap implementation
+ *
+ * the nodes are stored in the vector with an offset of 3,
+ * so that the root is at nodes[3] and the sons of the node i (0-based, not counting the offset)
+ * are 4*i+1 .. 4*i+4, which are stored at nodes[4*i+4] .. nodes[4*i+7]:
+ * with 16 bytes per node all four of them fill exactly one 64 bytes cache line
+ *
+ */
+
+namespace {
+
+const int offset = 3;
+const int arity = 4;
+
+inline int first_son(int i) { return arity*i+1; }
+inline int parent(int i) { return (i-1)/arity; }
+
+//the order of nodes: by keys and then by ids,
+//so that the ties are resolved the same way in all the priority queue backends
+inline bool precedes(const quaternary_heap_node & a, const quaternary_heap_node & b) {
+  return a.key < b.key or (a.key == b.key and a.id < b.id);
+}
+
+inline quaternary_heap_node & at(struct quaternary_heap & h, int i) { return h.nodes[i + offset]; }
+
+inline void place(struct quaternary_heap & h, int i, const quaternary_heap_node & node) {
+  at(h, i) = node;
+  h.reverse_lookup[node.id] = i;
+}
+
+int heapify_up(struct quaternary_heap & h, int i) {
+// moves the node i up the tree, returns its new index
+  quaternary_heap_node node = at(h, i);
+
+  while (i > 0) {
+    int p = parent(i);
+    if (!precedes(node, at(h, p)))
+      break;
+    place(h, i, at(h, p));
+    i = p;
+  }
+  place(h, i, node);
+  return i;
+}
+
+void heapify_down(struct quaternary_heap & h, int i) {
+// moves the node i down the tree
+  quaternary_heap_node node = at(h, i);
+
+  while (true) {
+    int first = first_son(i);
+    if (first >= h.count)
+      break;
+    int last = std::min(first + arity, h.count);
+
+    int minimal = first;
+    for (int son = first + 1; son < last; son++)
+      if (precedes(at(h, son), at(h, minimal)))
+        minimal = son;
+
+    if (!precedes(at(h, minimal), node))
+      break;
+    place(h, i, at(h, minimal));
+    i = minimal;
+  }
+  place(h, i, node);
+}
+
+}
+
+struct quaternary_heap init_quaternary_heap(std::vector<double> keys) {
+  struct quaternary_heap h;
+  init_quaternary_heap(h, keys);
+  return h;
+}
+
+void init_quaternary_heap(struct quaternary_heap & h, const std::vector<double> & keys) {
+  //the ids associated with keys are 0 .. keys.size() - 1
+
+  h.count = keys.size();
+  h.nodes.resize(h.count + offset);
+  h.reverse_lookup.resize(h.count);
+  for (int i = 0; i < h.count; i++) {
+    at(h, i).key = keys[i];
+    at(h, i).id = i;
+    h.reverse_lookup[i] = i;
+  }
+
+  for (int i = parent(h.count - 1); i >= 0; i--)   //parent of the last element is the first one
+    heapify_down(h, i);                            //which may need a rebuild
+}
+
+void init_quaternary_heap(struct quaternary_heap & h, const std::vector<double> & keys, const std::vector<int> & ids) {
+  //the same, but with the given ids only (and their keys at the ids in keys)
+
+  h.count = ids.size();
+  h.nodes.resize(h.count + offset);
+  h.reverse_lookup.resize(keys.size());
+  for (int i = 0; i < h.count; i++) {
+    at(h, i).key = keys[ids[i]];
+    at(h, i).id = ids[i];
+    h.reverse_lookup[ids[i]] = i;
+  }
+
+  for (int i = h.count > 0 ? parent(h.count - 1) : -1; i >= 0; i--)   //no ids at all if all the intervals are duplicates
+    heapify_down(h, i);
+}
+
+int size(struct quaternary_heap & h) { return h.count; }
+bool is_empty(struct quaternary_heap & h) { return h.count == 0; }
+
+std::pair<double, int> read_minimum(struct quaternary_heap & h) {
+  if (!is_empty(h))
+    return std::pair<double, int>(at(h, 0).key, at(h, 0).id);
+
+  return std::pair<double, int>(0.0, 0);   //for reading minimum of an empty heap
+}
+
+std::pair<double, int> remove_minimum(struct quaternary_heap & h) {
+  std::pair<double, int> r = read_minimum(h);
+  if (h.count > 1) {
+    h.count--;
+    place(h, 0, at(h, h.count));
+    heapify_down(h, 0);
+  } else
+    h.count = 0;
+  return r;
+}
+
+double read_key_by_id(struct quaternary_heap & h, int id) {
+  return at(h, h.reverse_lookup[id]).key;
+}
+
+void update_key_by_id(struct quaternary_heap & h, int id, double new_key) {
+  int index = h.reverse_lookup[id];
+  at(h, index).key = new_key;
+
+  //at most one of the corrections will proceed
+  if (heapify_up(h, index) == index)
+    heapify_down(h, index);
+}
@@ -0,0 +1,43 @@
+#ifndef QUATERNARY_HEAP_H
+
+#define QUATERNARY_HEAP_H
+#include <vector>  //std::vector
+#include <utility> //std::pair
+#include "cache_line_allocator.h"
+
+/*
+ *                     an iterative 4-ary heap implementation
+ *
+ * the same functionality as in heap.h, but:
+ *
+ * * each node has 4 sons, so the tree is half as deep as the binary one
+ * * a key and its id are packed together in one node, so comparing sons touches a single cache line
+ * * heapifying is iterative, with a hole moved along the path instead of swapping nodes
+ *
+ */
+
+struct quaternary_heap_node {
+  double key;
+  int id;
+};
+
+struct quaternary_heap {
+  std::vector<quaternary_heap_node, cache_line_allocator<quaternary_heap_node> > nodes;  //preceded by 3 unused nodes, so that the 4 sons of a node share a cache line
+  std::vector<int> reverse_lookup;
+  int count;
+};
+
+struct quaternary_heap init_quaternary_heap(std::vector<double> keys);
+void init_quaternary_heap(struct quaternary_heap & h, const std::vector<double> & keys);   //reusing the memory of h
+void init_quaternary_heap(struct quaternary_heap & h, const std::vector<double> & keys, const std::vector<int> & ids);   //the given ids only
+
+int size(struct quaternary_heap & h);
+bool is_empty(struct quaternary_heap & h);
+
+std::pair<double, int> read_minimum(struct quaternary_heap & h);
+std::pair<double, int> remove_minimum(struct quaternary_heap & h);
+
+double read_key_by_id(struct quaternary_heap & h, int id);
+void update_key_by_id(struct quaternary_heap & h, int id, double new_key);
+
+#endif
@@ -0,0 +1,306 @@
+#include <vector>  //std::vector
+#include <numeric> //std::iota
+#include <algorithm>  //std::fill
+#include <assert.h>
+#include "order.h"
+#include "parallel.h"
+#include "single.h"
+
+/*
+ *                     the merge labels of single linkage by a cartesian tree
+ *
+ * intervals merge in the order of their ranks (stages), so the merge at the stage of an interval i joins
+ * the cluster of the intervals merged just before it on its left (with the last of them merged at the greatest rank)
+ * and the same on its right. Those are the sons of i in the cartesian tree of ranks (a max-heap ordered by the interval positions),
+ * and the father of i is the one of its nearest greater ranks on the left and on the right that is smaller
+ *
+ * the nearest greater ranks are found by a stack scan of each chunk on its own thread,
+ * the scan leaves the ranks unresolved for the chunk's prefix (suffix) maxima only,
+ * and those get resolved by a binary search in the stacks left by the preceding (following) chunks
+ *
+ */
+
+//a stack scan of a chunk, either from left to right (step = 1) or from right to left (step = -1),
+//leaving the stack in stack[0 .. returned size - 1]
+static int nearest_greater_in_chunk(const int * rank, int begin, int end, int step, int * nearest, int * stack) {
+  int top = 0;
+  int first = step > 0 ? begin : end - 1;
+  for (int i = first; i >= begin and i < end; i += step) {
+    while (top > 0 and rank[stack[top - 1]] < rank[i])
+      top--;
+    nearest[i] = top > 0 ? stack[top - 1] : -2;   // -2 means "not in this chunk"
+    stack[top++] = i;
+  }
+  return top;
+}
+
+//the same direction as in nearest_greater_in_chunk
+static void nearest_greater_across_chunks(const int * rank, int size, int chunks, int chunk, int step, int * nearest,
+                                          const int * stack, const std::vector<int> & stack_size) {
+  int begin = chunk_begin(size, chunks, chunk);
+  int end = chunk_begin(size, chunks, chunk + 1);
+
+  //the unresolved ranks come in an increasing order of values, so the chunk holding the greater rank only moves away
+  int other = chunk - step;
+  int first = step > 0 ? begin : end - 1;
+  for (int i = first; i >= begin and i < end; i += step) {
+    if (nearest[i] != -2)
+      continue;
+
+    //the bottom of a stack is the maximum of its chunk
+    while (other >= 0 and other < chunks and rank[stack[chunk_begin(size, chunks, other)]] < rank[i])
+      other -= step;
+
+    if (other < 0 or other >= chunks) {
+      nearest[i] = -1;   // -1 means "no greater rank at all"
+      continue;
+    }
+
+    //the ranks in the stack decrease from the bottom to the top, the greater rank closest to i is the topmost
+    const int * other_stack = stack + chunk_begin(size, chunks, other);
+    int low = 0;
+    int high = stack_size[other];   //rank[other_stack[low]] > rank[i], rank[other_stack[high]] < rank[i] (or out)
+    while (high - low > 1) {
+      int middle = (low + high) / 2;
+      if (rank[other_stack[middle]] > rank[i])
+        low = middle;
+      else
+        high = middle;
+    }
+    nearest[i] = other_stack[low];
+  }
+}
+
+static void nearest_greater(const int * rank, int size, int chunks, int step, int * nearest, int * stack) {
+  std::vector<int> stack_size(chunks);
+  parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+    stack_size[chunk] = nearest_greater_in_chunk(rank, begin, end, step, nearest, stack + begin);
+  });
+  parallel_chunks(size, chunks, [&](int chunk, int begin, int end) {
+    nearest_greater_across_chunks(rank, size, chunks, chunk, step, nearest, stack, stack_size);
+  });
+}
+
+static void merge_by_cartesian_tree(const int * order_points, int intervals_size, const double * distances,
+                                    const int * order_distances, int chunks,
+                                    int * merge_left, int * merge_right, double * height) {
+
+  std::vector<int> rank(intervals_size);
+  parallel_chunks(intervals_size, chunks, [&](int chunk, int begin, int end) {
+    for (int stage = begin; stage < end; stage++)
+      rank[order_distances[stage]] = stage;
+  });
+
+  std::vector<int> greater_left(intervals_size);
+  std::vector<int> greater_right(intervals_size);
+  std::vector<int> left_son(intervals_size);
+  std::vector<int> right_son(intervals_size);
+  nearest_greater(rank.data(), intervals_size, chunks, 1, greater_left.data(), left_son.data());
+  nearest_greater(rank.data(), intervals_size, chunks, -1, greater_right.data(), left_son.data());
+
+  std::fill(left_son.begin(), left_son.end(), -1);   // -1 means "a singleton"
+  std::fill(right_son.begin(), right_son.end(), -1);
+  parallel_chunks(intervals_size, chunks, [&](int chunk, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      int left = greater_left[i];
+      int right = greater_right[i];
+      if (left > -1 and (right == -1 or rank[left] < rank[right]))
+        right_son[left] = i;
+      else if (right > -1)
+        left_son[right] = i;
+    }
+  });
+
+  parallel_chunks(intervals_size, chunks, [&](int chunk, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      int stage = rank[i];
+      merge_left[stage] = left_son[i] > -1 ? rank[left_son[i]] + 1 : -order_points[i] - 1;
+      merge_right[stage] = right_son[i] > -1 ? rank[right_son[i]] + 1 : -order_points[i + 1] - 1;
+      height[stage] = distances[i];
+    }
+  });
+}
+
+//duplicates: the distances 0 (between equal points) come first in the order, by their positions,
+//so only the positive distances need sorting, which for data with many duplicates are about as many as unique values
+static void order_distances_of_duplicates(const std::vector<double> & distances, int threads, struct single_workspace & w,
+                                          std::vector<int> & order_distances) {
+  int intervals_size = distances.size();
+
+  int zeros = 0;
+  bool positive = true;   //otherwise (a NaN of infinite points) the sort decides
+  for (int i = 0; i < intervals_size; i++) {
+    zeros += distances[i] == 0.0;
+    positive = positive and distances[i] >= 0.0;
+  }
+
+  if (zeros == 0 or not positive) {
+    order(distances.data(), intervals_size, order_distances.data(), threads, w.sorting);
+    return;
+  }
+
+  std::vector<double> & positive_distances = w.positive_distances;
+  std::vector<int> & positive_ids = w.positive_ids;
+  positive_distances.clear();
+  positive_ids.clear();
+  int zero = 0;
+  for (int i = 0; i < intervals_size; i++)
+    if (distances[i] == 0.0)
+      order_distances[zero++] = i;
+    else {
+      positive_distances.push_back(distances[i]);
+      positive_ids.push_back(i);
+    }
+
+  int * order_positive = order_distances.data() + zeros;
+  order(positive_distances.data(), positive_distances.size(), order_positive, threads, w.sorting);
+  for (int i = 0; i < intervals_size - zeros; i++)
+    order_positive[i] = positive_ids[order_positive[i]];
+}
+
+//the merges for the distances within intervals in w.distances
+static void single_merges_of_distances(const int * order_points, int points_size, int threads, struct single_workspace & w,
+                                       int * merge_left, int * merge_right, double * height, struct profile * p) {
+  std::vector<int> & order_distances = w.order_distances;
+  order_distances.resize(points_size - 1);
+  order_distances_of_duplicates(w.distances, threads, w, order_distances);
+  profile_lap(p, queue_phase);
+
+  single_merges_ordered(order_points, points_size, w.distances.data(), order_distances.data(), threads, w,
+                        merge_left, merge_right, height);
+  profile_lap(p, merges_phase);
+}
+
+void single_merges(const double * points, int points_size, int threads, struct single_workspace & w,
+                   int * order_points, int * merge_left, int * merge_right, double * height, struct profile * p) {
+// only single linkage case,
+// which doesn't need a heap because the cluster distances are the same as singleton distances
+
+  int chunks = chunks_count(points_size - 1, threads);
+
+  order(points, points_size, order_points, threads, w.sorting);
+  profile_lap(p, sort_phase);
+
+
+  //the sequence indexed by the numbers of intervals (there are points_size - 1 intervals)
+  //and returning an index of a left point in each interval (as if they were ordered, but they are not)
+  auto left_seq = [&](int i) {
+    //input: indexes from 0 to points_size - 2, count: points_size - 1
+    //output: indexes from 0 to points_size -2
+    assert(i >= 0 and i < points_size - 1);
+    return i;
+  };
+
+  //the sequence indexed by the numbers of intervals (there are points_size - 1 intervals)
+  //and returning an index of a right point in each interval (as if they were ordered, but they are not)
+  auto right_seq = [&](int i) {
+    //input: indexes from 0 to points_size - 2, count: points_size - 1
+    //output: indexes from 1 to points_size - 1
+    assert(i >= 0 and i < points_size - 1);
+    return i + 1;
+  };
+
+  //the sequence indexed by the numbers of intervals (there are points_size - 1 intervals)
+  //and returning an index of a left point in each interval
+  auto left_indexes = [&](int i) {
+    //input: indexes from 0 to points_size - 2, count: points_size - 1
+    assert(i >= 0 and i < points_size - 1);
+    return order_points[left_seq(i)];
+  };
+
+  //the sequence indexed by the numbers of intervals (there are points_size - 1 intervals)
+  //and returning an index of a right point in each interval
+  auto right_indexes = [&](int i) {
+    //input: indexes from 0 to points_size - 2, count: points_size - 1
+    assert(i >= 0 and i < points_size - 1);
+    return order_points[right_seq(i)];
+  };
+
+  std::vector<double> & distances = w.distances;
+  distances.resize(points_size - 1);
+  //the sequence of distances within intervals (there are points_size - 1 intervals)
+  parallel_chunks(points_size - 1, chunks, [&](int chunk, int begin, int end) {
+    for (int i = begin; i < end; i++)
+      distances[i] = points[right_indexes(i)] - points[left_indexes(i)];
+  });
+  profile_lap(p, gaps_phase);
+
+  single_merges_of_distances(order_points, points_size, threads, w, merge_left, merge_right, height, p);
+}
+
+void single_merges_sorted(const int * order_points, const double * sorted_points, int points_size, int threads,
+                          struct single_workspace & w, int * merge_left, int * merge_right, double * height, struct profile * p) {
+// the same distances as in single_merges(), read from the points already sorted
+
+  std::vector<double> & distances = w.distances;
+  distances.resize(points_size - 1);
+  parallel_chunks(points_size - 1, chunks_count(points_size - 1, threads), [&](int chunk, int begin, int end) {
+    for (int i = begin; i < end; i++)
+      distances[i] = sorted_points[i + 1] - sorted_points[i];
+  });
+  profile_lap(p, gaps_phase);
+
+  single_merges_of_distances(order_points, points_size, threads, w, merge_left, merge_right, height, p);
+}
+
+void single_merges_ordered(const int * order_points, int points_size, const double * distances, const int * order_distances,
+                           int threads, struct single_workspace & w, int * merge_left, int * merge_right, double * height) {
+// the merges for the points and the distances already sorted
+
+  int chunks = chunks_count(points_size - 1, threads);
+
+  //the indexes of the left and the right points in each interval
+  auto left_indexes = [&](int i) {
+    assert(i >= 0 and i < points_size - 1);
+    return order_points[i];
+  };
+  auto right_indexes = [&](int i) {
+    assert(i >= 0 and i < points_size - 1);
+    return order_points[i + 1];
+  };
+
+  if (chunks > 1) {
+    merge_by_cartesian_tree(order_points, points_size - 1, distances, order_distances, chunks, merge_left, merge_right, height);
+  } else {
+    std::vector<int> & interval_left_ids = w.interval_left_ids;
+    interval_left_ids.resize(points_size - 1);
+    std::iota(interval_left_ids.begin(), interval_left_ids.end(), -1);
+                // in C++: -1 means "no id to the left"
+
+    std::vector<int> & interval_right_ids = w.interval_right_ids;
+    interval_right_ids.resize(points_size - 1);
+    std::iota(interval_right_ids.begin(), interval_right_ids.end(), 1);
+    interval_right_ids.back() = -1; // in C++: -1 means "no id to the right"
+
+    std::vector<int> & left_merges = w.left_merges;
+    std::vector<int> & right_merges = w.right_merges;
+    left_merges.resize(points_size - 1);
+    right_merges.resize(points_size - 1);
+    for (int i=0; i<points_size - 1; i++) {
+      left_merges[i] = -left_indexes(i) - 1;
+      right_merges[i] = -right_indexes(i) - 1;
+    }
+
+    for (int stage = 0; stage < points_size - 1; stage++) {
+
+      int id = order_distances[stage];
+      int left_id = interval_left_ids[id];
+      int right_id = interval_right_ids[id];
+
+      merge_left[stage] = left_merges[id];
+      merge_right[stage] = right_merges[id];
+
+      height[stage] = distances[order_distances[stage]];
+
+      if (left_id > -1) {
+          interval_right_ids[left_id] = right_id;
+          right_merges[left_id] = stage + 1;
+        }
+
+      if (right_id > -1) {
+          interval_left_ids[right_id] = left_id;
+          left_merges[right_id] = stage + 1;
+        }
+      }
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef SINGLE_H
+
+#define SINGLE_H
+#include <vector>  //std::vector
+#include "order.h"
+#include "profile.h"
+
+/*
+ *                     single linkage on raw arrays
+ *
+ * single_merges() reads points_size points and writes the (0-based) order of the points, the merge columns
+ * and the heights to the arrays given, of lengths points_size, points_size - 1, points_size - 1 and points_size - 1,
+ * using no R objects
+ *
+ * single_merges_sorted() does the same for the order of the points and the points in that order already known
+ * (as shared by the linkages clustered together in multi.cpp), with no sorting of the points
+ *
+ * single_merges_ordered() does the same for the order of the points and the distances within intervals already known
+ * (as kept by a dynamic dendrogram, see hclust1d_dynamic.cpp), with no sorting at all
+ *
+ * the wall time of the phases of single_merges() and single_merges_sorted() is added to the profile given, if any (see profile.h)
+ *
+ * the workspace holds the buffers of the serial relabel loop, and reusing it over many calls
+ * (as in hclust1d_batch.cpp) allocates only when a call needs more memory than any call before
+ *
+ */
+
+struct single_workspace {
+  std::vector<double> distances;
+  std::vector<int> order_distances;
+  std::vector<double> positive_distances;
+  std::vector<int> positive_ids;
+  std::vector<int> interval_left_ids;
+  std::vector<int> interval_right_ids;
+  std::vector<int> left_merges;
+  std::vector<int> right_merges;
+  struct order_workspace sorting;
+};
+
+void single_merges(const double * points, int points_size, int threads, struct single_workspace & w,
+                   int * order_points, int * merge_left, int * merge_right, double * height, struct profile * p = NULL);
+
+void single_merges_sorted(const int * order_points, const double * sorted_points, int points_size, int threads,
+                          struct single_workspace & w, int * merge_left, int * merge_right, double * height, struct profile * p = NULL);
+
+void single_merges_ordered(const int * order_points, int points_size, const double * distances, const int * order_distances,
+                           int threads, struct single_workspace & w, int * merge_left, int * merge_right, double * height);
+
+#endif
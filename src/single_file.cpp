@@ -0,0 +1,147 @@
+#include <cstdint>  //std::int64_t
+#include <cmath>  //std::isfinite
+#include <string>  //std::string
+#include <memory>  //std::unique_ptr
+#include <stdexcept>  //std::length_error, std::domain_error
+#include "external_sort.h"
+#include "single_file.h"
+
+//the records of the sorts, each ordered totally
+
+struct sorted_point {
+  double value;
+  std::int64_t index;
+};
+
+struct by_value {
+  bool operator()(const sorted_point & a, const sorted_point & b) const {
+    return a.value < b.value or (a.value == b.value and a.index < b.index);
+  }
+};
+
+struct interval_distance {
+  double distance;
+  std::int64_t position;
+};
+
+struct by_distance {
+  bool operator()(const interval_distance & a, const interval_distance & b) const {
+    return a.distance < b.distance or (a.distance == b.distance and a.position < b.position);
+  }
+};
+
+struct interval_stage {
+  std::int64_t position;
+  std::int64_t stage;
+};
+
+struct by_position {
+  bool operator()(const interval_stage & a, const interval_stage & b) const { return a.position < b.position; }
+};
+
+struct merge_row {
+  std::int64_t stage;
+  std::int64_t left;
+  std::int64_t right;
+  double height;
+};
+
+struct by_stage {
+  bool operator()(const merge_row & a, const merge_row & b) const { return a.stage < b.stage; }
+};
+
+//an interval on the stack of the cartesian tree, its left son is known already
+struct open_interval {
+  std::int64_t stage;
+  std::int64_t left;
+  std::int64_t right_point;   //the label of the right singleton, unless a right son comes
+  double height;
+};
+
+std::int64_t single_merges_file(const std::string & points_path, const std::string & merges_path, const std::string & order_path,
+                                std::int64_t memory, const std::string & temporary_directory) {
+// at most two sorts (one being merged, one being collected) and the stack are held at a time,
+// each with a third of memory
+
+  std::int64_t part = memory / 3;
+  temporary_file sorted_points(temporary_directory);
+
+  //the points and the distances between the consecutive sorted ones
+  std::int64_t points_size = 0;
+  external_sorter<interval_distance, by_distance> distances(part, temporary_directory);
+  {
+    external_sorter<sorted_point, by_value> points(part, temporary_directory);
+    record_reader<double> input(points_path);
+    for (double value; input.read(value); points_size++) {
+      if (not std::isfinite(value))
+        throw std::domain_error("a point in the file " + points_path + " is NaN or infinite");
+      points.add({value, points_size});
+    }
+    if (points_size < 2)
+      throw std::length_error("at least two points are needed in the file " + points_path);
+
+    record_writer<sorted_point> sorted(sorted_points.path);
+    std::unique_ptr<record_writer<double> > order;
+    if (not order_path.empty())
+      order.reset(new record_writer<double>(order_path));
+    std::int64_t position = 0;
+    double previous = 0.0;
+    points.finish([&](const sorted_point & point) {
+      sorted.write(point);
+      if (order)
+        order->write((double)(point.index + 1));    //R conformant
+      if (position > 0)
+        distances.add({point.value - previous, position - 1});
+      previous = point.value;
+      position++;
+    });
+    sorted.close();
+    if (order)
+      order->close();
+  }
+
+  //the stages of the intervals, by their positions
+  external_sorter<interval_stage, by_position> stages(part, temporary_directory);
+  std::int64_t stage = 0;
+  distances.finish([&](const interval_distance & interval) {
+    stages.add({interval.position, stage++});
+  });
+
+  //the cartesian tree of the stages (a max-heap ordered by the positions), in a single scan with a stack
+  //holding the stages decreasing from the bottom to the top: an interval of a greater stage pops the ones of smaller stages,
+  //each popped interval is the right son of the one below it, and the last one popped is the left son of the one pushed
+  external_sorter<merge_row, by_stage> merges(part, temporary_directory);
+  spill_stack<open_interval> stack(part, temporary_directory);
+  auto pop_below = [&](std::int64_t stage) {
+    std::int64_t son = -1;   // -1 means "a singleton"
+    while (not stack.empty() and stack.back().stage < stage) {
+      open_interval & interval = stack.back();
+      merges.add({interval.stage, interval.left, son > -1 ? son + 1 : interval.right_point, interval.height});
+      son = interval.stage;
+      stack.pop();
+    }
+    return son;
+  };
+
+  record_reader<sorted_point> sorted(sorted_points.path);
+  sorted_point left_point, right_point;
+  sorted.read(left_point);
+  stages.finish([&](const interval_stage & interval) {
+    sorted.read(right_point);
+    std::int64_t left_son = pop_below(interval.stage);
+    stack.push({interval.stage, left_son > -1 ? left_son + 1 : -left_point.index - 1, -right_point.index - 1,
+                right_point.value - left_point.value});
+    left_point = right_point;
+  });
+  pop_below(points_size);
+
+  record_writer<double> output(merges_path);
+  merges.finish([&](const merge_row & merge) {
+    output.write((double)merge.left);
+    output.write((double)merge.right);
+    output.write(merge.height);
+  });
+  output.close();
+
+  return points_size;
+}
@@ -0,0 +1,35 @@
+#ifndef SINGLE_FILE_H
+
+#define SINGLE_FILE_H
+#include <cstdint>  //std::int64_t
+#include <string>  //std::string
+
+/*
+ *                     single linkage out of core
+ *
+ * single_merges_file() clusters the points of a binary file (native doubles, as written by writeBin(x, file) in R)
+ * with nothing of the size of the points held in memory: all the data of that size goes through
+ * the external sorts and the stack of external_sort.h, within about memory bytes, in temporary files
+ * in the directory given
+ *
+ * * the points get sorted (with ties by their indices, as order() does), and the distances between
+ *   the consecutive sorted points get sorted (with ties by their positions, as in single_merges()),
+ *   which gives the stage of each interval
+ * * the merges come from a single scan of the intervals in their order, with a stack building
+ *   the cartesian tree of their stages (as merge_by_cartesian_tree() in single.cpp does in memory):
+ *   an interval leaves the stack with both of its sons known, and so with its merge known
+ * * the merges get sorted by their stages and streamed to the merges file as they come out of the sort
+ *
+ * the files written hold native doubles: the merges file holds points_size - 1 rows of merge[, 1], merge[, 2] and height,
+ * numbered as in hclust in R; the order file (if its path is not empty) holds the (1-based) order of the points.
+ * The results are the same as of single_merges() (see single.h)
+ *
+ * returns points_size; throws a file_error (see external_sort.h), a std::length_error for fewer than 2 points,
+ * and a std::domain_error for a point that is NaN or infinite
+ *
+ */
+
+std::int64_t single_merges_file(const std::string & points_path, const std::string & merges_path, const std::string & order_path,
+                                std::int64_t memory, const std::string & temporary_directory);
+
+#endif
@@ -0,0 +1,114 @@
+#include "tournament_tree.h"
+#include <limits>  //std::numeric_limits
+
+/*
+ *                     a min-tournament tree implementation
+ *
+ * in the merge loop the keys get updated at the two neighbours of the merged interval,
+ * which are also neighbours in the tree, so the paths to the root mostly overlap
+ *
+ */
+
+namespace {
+
+//the order of ids: by keys and then by ids,
+//so that the ties are resolved the same way in all the priority queue backends;
+//a removed leaf loses whatever the keys, also to a key of +infinity
+inline const tournament_tree_node & match(const tournament_tree_node & a, const tournament_tree_node & b) {
+  if (a.id == removed_id)
+    return b;
+  if (b.id == removed_id)
+    return a;
+  if (b.key < a.key or (b.key == a.key and b.id < a.id))
+    return b;
+  return a;
+}
+
+void replay(struct tournament_tree & t, int id) {
+// replays the matches on the path from the leaf id to the root
+// as soon as a match ends with the same winner (and key) as before, the rest of the path is up to date
+  for (int i = (id + t.leaves_count) / 2; i >= 1; i /= 2) {
+    const tournament_tree_node & winner = match(t.nodes[2*i], t.nodes[2*i+1]);
+    if (winner.id == t.nodes[i].id and winner.key == t.nodes[i].key and winner.id != id)
+      break;
+    t.nodes[i] = winner;
+  }
+}
+
+}
+
+struct tournament_tree init_tournament_tree(std::vector<double> keys) {
+  struct tournament_tree t;
+  init_tournament_tree(t, keys);
+  return t;
+}
+
+void init_tournament_tree(struct tournament_tree & t, const std::vector<double> & keys) {
+  //the ids associated with keys are 0 .. keys.size() - 1
+
+  t.count = keys.size();
+  t.leaves_count = 1;
+  while (t.leaves_count < t.count)
+    t.leaves_count *= 2;
+
+  t.nodes.resize(2 * t.leaves_count);
+  for (int i = 0; i < t.leaves_count; i++) {
+    t.nodes[t.leaves_count + i].key = i < t.count ? keys[i] : std::numeric_limits<double>::infinity();
+    t.nodes[t.leaves_count + i].id = i < t.count ? i : removed_id;
+  }
+  for (int i = t.leaves_count - 1; i >= 1; i--)
+    t.nodes[i] = match(t.nodes[2*i], t.nodes[2*i+1]);
+}
+
+void init_tournament_tree(struct tournament_tree & t, const std::vector<double> & keys, const std::vector<int> & ids) {
+  //the same, but with the given ids only (and their keys at the ids in keys), the other leaves are removed keys
+
+  t.count = ids.size();
+  t.leaves_count = 1;
+  while (t.leaves_count < (int)keys.size())
+    t.leaves_count *= 2;
+
+  t.nodes.resize(2 * t.leaves_count);
+  for (int i = 0; i < t.leaves_count; i++) {
+    t.nodes[t.leaves_count + i].key = std::numeric_limits<double>::infinity();
+    t.nodes[t.leaves_count + i].id = removed_id;
+  }
+  for (int id: ids) {
+    t.nodes[t.leaves_count + id].key = keys[id];
+    t.nodes[t.leaves_count + id].id = id;
+  }
+  for (int i = t.leaves_count - 1; i >= 1; i--)
+    t.nodes[i] = match(t.nodes[2*i], t.nodes[2*i+1]);
+}
+
+int size(struct tournament_tree & t) { return t.count; }
+bool is_empty(struct tournament_tree & t) { return t.count == 0; }
+
+std::pair<double, int> read_minimum(struct tournament_tree & t) {
+  if (!is_empty(t)) {
+    return std::pair<double, int>(t.nodes[1].key, t.nodes[1].id);
+  }
+
+  return std::pair<double, int>(0.0, 0);   //for reading minimum of an empty tree
+}
+
+std::pair<double, int> remove_minimum(struct tournament_tree & t) {
+  std::pair<double, int> r = read_minimum(t);
+  if (!is_empty(t)) {
+    t.nodes[t.leaves_count + r.second].key = std::numeric_limits<double>::infinity();
+    t.nodes[t.leaves_count + r.second].id = removed_id;
+    replay(t, r.second);
+    t.count--;
+  }
+  return r;
+}
+
+double read_key_by_id(struct tournament_tree & t, int id) {
+  return t.nodes[t.leaves_count + id].key;
+}
+
+void update_key_by_id(struct tournament_tree & t, int id, double new_key) {
+  t.nodes[t.leaves_count + id].key = new_key;
+  t.nodes[t.leaves_count + id].id = id;
+  replay(t, id);
+}
@@ -0,0 +1,51 @@
+#ifndef TOURNAMENT_TREE_H
+
+#define TOURNAMENT_TREE_H
+#include <vector>  //std::vector
+#include <utility> //std::pair
+
+/*
+ *                     a min-tournament tree implementation
+ *
+ * the same functionality as in heap.h, but the keys never move:
+ * they are stored at their ids (which are the interval positions in the merge loop)
+ * and the internal nodes of a complete binary tree above them hold the id of the winner (the minimum)
+ * of their subtree
+ *
+ * * no reverse_lookup is needed for updating a key by id, the leaf is at the id
+ * * an update replays the matches on the path from the leaf to the root only
+ * * a removed leaf gets removed_id (and a key of +infinity), so the tree never changes its shape;
+ *   it loses every match, also to a key that overflowed to +infinity
+ * * each node keeps a copy of the winner's key next to its id, so a match reads the two sons only
+ *
+ */
+
+const int removed_id = -1;   //the id of a removed leaf (or of a padding one)
+
+struct tournament_tree_node {
+  double key;
+  int id;
+};
+
+struct tournament_tree {
+  std::vector<tournament_tree_node> nodes;  //nodes[1] is the root, sons of i are 2*i and 2*i+1,
+                                            //the leaf of the id is nodes[leaves_count + id],
+                                            //padded with removed leaves up to leaves_count leaves
+  int leaves_count;
+  int count;
+};
+
+struct tournament_tree init_tournament_tree(std::vector<double> keys);
+void init_tournament_tree(struct tournament_tree & t, const std::vector<double> & keys);   //reusing the memory of t
+void init_tournament_tree(struct tournament_tree & t, const std::vector<double> & keys, const std::vector<int> & ids);   //the given ids only
+
+int size(struct tournament_tree & t);
+bool is_empty(struct tournament_tree & t);
+
+std::pair<double, int> read_minimum(struct tournament_tree & t);
+std::pair<double, int> remove_minimum(struct tournament_tree & t);
+
+double read_key_by_id(struct tournament_tree & t, int id);
+void update_key_by_id(struct tournament_tree & t, int id, double new_key);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef WORKSPACE_H
+
+#define WORKSPACE_H
+#include <map>  //std::map
+#include <memory>  //std::shared_ptr, std::make_shared
+#include <typeindex>  //std::type_index
+
+/*
+ *                     a workspace reused over calls
+ *
+ * hclust1d_workspace() in R (see hclust1d_workspace.h) and hclust1d_workspace_new() in C (see hclust1d_c.h)
+ * return a workspace, and the clustering called with it takes the buffers of its merge loops from there
+ * instead of allocating them, so clustering many times on data of similar sizes allocates
+ * only when a call needs more memory than any call before
+ *
+ * the workspaces of the merge loops (see heapbased.h, single.h and nnchain.h) are of different types,
+ * one per linkage and priority queue backend, so they are kept by their types, each made on its first use
+ *
+ * without a workspace given (NULL), the loops get a workspace of their own for the call
+ *
+ */
+
+struct hclust1d_workspace {
+  std::map<std::type_index, std::shared_ptr<void> > workspaces;
+};
+
+//the workspace of the given type, made on the first use
+template <class workspace>
+workspace & reused(struct hclust1d_workspace & w) {
+  std::shared_ptr<void> & reused = w.workspaces[std::type_index(typeid(workspace))];
+  if (not reused)
+    reused = std::make_shared<workspace>();
+  return *static_cast<workspace *>(reused.get());
+}
+
+#endif
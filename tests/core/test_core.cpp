@@ -0,0 +1,628 @@
+// tests of the Rcpp-free core and of its C interface, run by ctest (see CMakeLists.txt);
+// the R package is tested with testthat, see tests/testthat
+
+#include <cstdio>  //std::printf, std::fopen, std::fwrite, std::fread, std::remove
+#include <cmath>  //std::nan, std::isfinite
+#include <random>  //std::mt19937, std::normal_distribution
+#include <vector>  //std::vector
+#include <string>  //std::string
+#include <algorithm>  //std::copy, std::sort, std::upper_bound
+#include <stdexcept>  //std::invalid_argument
+#include <utility>  //std::make_pair
+#include "hclust1d_c.h"
+#include "heapbased.h"
+#include "nnchain.h"
+#include "single.h"
+#include "bootstrap.h"
+#include "external_sort.h"
+#include "dendrogram_file.h"
+#include "cut_index.h"
+
+static int failures = 0;
+
+static void expect(bool condition, const char * test, const char * what) {
+  if (not condition) {
+    std::printf("FAILED %s: %s\n", test, what);
+    failures++;
+  }
+}
+
+struct dendrogram {
+  std::vector<int> merge_left;
+  std::vector<int> merge_right;
+  std::vector<double> height;
+  std::vector<int> order;
+
+  explicit dendrogram(int points_size)
+    : merge_left(points_size - 1), merge_right(points_size - 1), height(points_size - 1), order(points_size) {}
+
+  bool operator==(const dendrogram & d) const {
+    return merge_left == d.merge_left and merge_right == d.merge_right and height == d.height and order == d.order;
+  }
+};
+
+static int cluster(const std::vector<double> & points, int method, struct hclust1d_workspace * workspace, dendrogram & d,
+                   int threads = 1) {
+  return hclust1d_cluster(points.data(), points.size(), method, threads, workspace,
+                          d.merge_left.data(), d.merge_right.data(), d.height.data(), d.order.data());
+}
+
+template <class linkage, class queue = struct heap>
+static dendrogram heapbased(const std::vector<double> & points) {
+  dendrogram d(points.size());
+  heapbased_workspace<linkage, queue> w;
+  dendrogram_sink merges = {d.merge_left.data(), d.merge_right.data(), d.height.data()};
+  heapbased_merges(points.data(), points.size(), w, d.order.data(), merges);
+  return d;
+}
+
+template <class linkage>
+static dendrogram nnchain(const std::vector<double> & points, int threads = 1) {
+  dendrogram d(points.size());
+  nnchain_workspace<linkage> w;
+  nnchain_merges(points.data(), points.size(), threads, w, d.order.data(), d.merge_left.data(), d.merge_right.data(), d.height.data());
+  return d;
+}
+
+static std::vector<double> random_points(int points_size, int distinct, unsigned seed) {
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> normal;
+  std::vector<double> points(points_size);
+  for (double & point: points)
+    point = distinct > 0 ? (double)(generator() % distinct) : normal(generator);
+  return points;
+}
+
+static void test_small_example() {
+  const char * test = "the merges of a small example are as in hclust1d in R";
+  std::vector<double> points = {8, 1, 4, 2};
+
+  dendrogram complete(points.size());
+  expect(cluster(points, HCLUST1D_COMPLETE, NULL, complete) == HCLUST1D_OK, test, "complete status");
+  expect(complete.merge_left == std::vector<int>({-2, 1, 2}), test, "complete merge_left");
+  expect(complete.merge_right == std::vector<int>({-4, -3, -1}), test, "complete merge_right");
+  expect(complete.height == std::vector<double>({1, 3, 7}), test, "complete height");
+  expect(complete.order == std::vector<int>({1, 3, 2, 0}), test, "complete order");
+
+  dendrogram single(points.size());
+  expect(cluster(points, HCLUST1D_SINGLE, NULL, single) == HCLUST1D_OK, test, "single status");
+  expect(single.height == std::vector<double>({1, 2, 4}), test, "single height");
+  expect(single.merge_left == complete.merge_left, test, "single merge_left");
+  expect(single.merge_right == complete.merge_right, test, "single merge_right");
+}
+
+static void test_heap() {
+  const char * test = "the binary heap keeps its minimum at the root";
+
+  //a key decreased at the root's left son goes up to the root
+  struct heap decreased = init_heap({5, 7, 9});
+  int id = decreased.ids[1];
+  update_key_by_id(decreased, id, 1);
+  expect(read_minimum(decreased) == std::make_pair(1.0, id), test, "decreased key at node 1");
+  expect(remove_minimum(decreased) == std::make_pair(1.0, id), test, "decreased key at node 1 removed");
+  expect(read_minimum(decreased).first == 5, test, "the root after the decreased key");
+
+  //and so does a key inserted there
+  struct heap inserted = init_heap({5});
+  id = insert(inserted, 3);
+  expect(read_minimum(inserted) == std::make_pair(3.0, id), test, "inserted key at node 1");
+
+  //equal keys come out by their ids (the interval positions)
+  struct heap tied = init_heap({2, 1, 2, 2, 1});
+  update_key_by_id(tied, 3, 1);
+  std::vector<int> ids;
+  while (not is_empty(tied))
+    ids.push_back(remove_minimum(tied).second);
+  expect(ids == std::vector<int>({1, 3, 4, 0, 2}), test, "ties by ids");
+}
+
+static void test_queue_backends() {
+  const char * test = "all the priority queue backends give the same results";
+
+  //the keys overflow to +infinity, and a removed key must not come back as the minimum
+  std::vector<double> overflowing = {-1e308, 0, 1e308};
+  dendrogram d = heapbased<centroid_linkage>(overflowing);
+  expect(d.merge_left == std::vector<int>({-1, 1}), test, "overflowing merge_left");
+  expect(d.merge_right == std::vector<int>({-2, -3}), test, "overflowing merge_right");
+  expect(d == heapbased<centroid_linkage, struct quaternary_heap>(overflowing), test, "overflowing quaternary heap");
+  expect(d == heapbased<centroid_linkage, struct tournament_tree>(overflowing), test, "overflowing tournament tree");
+  d = heapbased<ward_D2_linkage>(overflowing);
+  expect(d == heapbased<ward_D2_linkage, struct quaternary_heap>(overflowing), test, "overflowing ward.D2 quaternary heap");
+  expect(d == heapbased<ward_D2_linkage, struct tournament_tree>(overflowing), test, "overflowing ward.D2 tournament tree");
+
+  for (int distinct: {0, 10}) {
+    std::vector<double> points = random_points(3000, distinct, 11 + distinct);
+    d = heapbased<average_linkage>(points);
+    expect(d == heapbased<average_linkage, struct quaternary_heap>(points), test, "average quaternary heap");
+    expect(d == heapbased<average_linkage, struct tournament_tree>(points), test, "average tournament tree");
+    d = heapbased<centroid_linkage>(points);
+    expect(d == heapbased<centroid_linkage, struct quaternary_heap>(points), test, "centroid quaternary heap");
+    expect(d == heapbased<centroid_linkage, struct tournament_tree>(points), test, "centroid tournament tree");
+  }
+
+  //a removed key loses to any key, also to +infinity, whatever the ids
+  struct tournament_tree t = init_tournament_tree({1, 2, 3});
+  expect(remove_minimum(t) == std::make_pair(1.0, 0), test, "tournament tree minimum");
+  update_key_by_id(t, 1, 1.0 / 0.0);
+  update_key_by_id(t, 2, 1.0 / 0.0);
+  expect(remove_minimum(t) == std::make_pair(1.0 / 0.0, 1), test, "tournament tree +infinity after a removed key");
+  expect(remove_minimum(t) == std::make_pair(1.0 / 0.0, 2), test, "tournament tree last +infinity");
+  expect(is_empty(t), test, "tournament tree empty");
+}
+
+static void test_engines() {
+  const char * test = "the C interface gives the same results as the heap-based merge loop";
+  for (int distinct: {0, 10, 1000}) {
+    std::vector<double> points = random_points(5000, distinct, 1 + distinct);
+    dendrogram d(points.size());
+
+    cluster(points, HCLUST1D_COMPLETE, NULL, d);
+    expect(d == heapbased<complete_linkage>(points), test, "complete");
+    cluster(points, HCLUST1D_AVERAGE, NULL, d);
+    expect(d == heapbased<average_linkage>(points), test, "average");
+    cluster(points, HCLUST1D_MCQUITTY, NULL, d);
+    expect(d == heapbased<mcquitty_linkage>(points), test, "mcquitty");
+    cluster(points, HCLUST1D_WARD_D, NULL, d);
+    expect(d == heapbased<ward_D_linkage>(points), test, "ward.D");
+    cluster(points, HCLUST1D_WARD_D2, NULL, d);
+    expect(d == heapbased<ward_D2_linkage>(points), test, "ward.D2");
+    cluster(points, HCLUST1D_CENTROID, NULL, d);
+    expect(d == heapbased<centroid_linkage>(points), test, "centroid");
+    cluster(points, HCLUST1D_MEDIAN, NULL, d);
+    expect(d == heapbased<median_linkage>(points), test, "median");
+    cluster(points, HCLUST1D_TRUE_MEDIAN, NULL, d);
+    expect(d == heapbased<true_median_linkage>(points), test, "true_median");
+    expect(nnchain<single_linkage>(points) == heapbased<single_linkage>(points), test, "nnchain single");
+
+    //the merges of tied heights may differ, but the heights are the same
+    dendrogram single(points.size());
+    cluster(points, HCLUST1D_SINGLE, NULL, single);
+    expect(single.height == heapbased<single_linkage>(points).height, test, "single height");
+    expect(single.order == heapbased<single_linkage>(points).order, test, "single order");
+  }
+}
+
+static void test_large_ward() {
+  const char * test = "ward linkages of clusters with more than 46340 points each have finite, increasing heights";
+  std::vector<double> points = random_points(200000, 0, 7);
+  for (int method: {HCLUST1D_WARD_D, HCLUST1D_WARD_D2}) {
+    dendrogram d(points.size());
+    cluster(points, method, NULL, d);
+    bool increasing = true;
+    for (size_t stage = 0; stage < d.height.size(); stage++)
+      if (not std::isfinite(d.height[stage]) or (stage > 0 and d.height[stage] < d.height[stage - 1]))
+        increasing = false;
+    expect(increasing, test, method == HCLUST1D_WARD_D ? "ward.D" : "ward.D2");
+  }
+}
+
+static void test_nnchain_rounds() {
+  const char * test = "the rounds of merges on many threads give the same results as the chain";
+  std::vector<std::vector<double> > inputs = {random_points(300000, 0, 11), random_points(300000, 1000, 12)};
+  inputs.push_back(std::vector<double>(200000));
+  for (size_t i = 0; i < inputs.back().size(); i++)
+    inputs.back()[i] = (double)i * i;   //presorted, with increasing gaps: a single minimum in a round
+
+  for (const std::vector<double> & points: inputs)
+    for (int threads: {2, 8}) {
+      expect(nnchain<complete_linkage>(points, threads) == nnchain<complete_linkage>(points), test, "complete");
+      expect(nnchain<average_linkage>(points, threads) == nnchain<average_linkage>(points), test, "average");
+      expect(nnchain<mcquitty_linkage>(points, threads) == nnchain<mcquitty_linkage>(points), test, "mcquitty");
+      expect(nnchain<ward_D_linkage>(points, threads) == nnchain<ward_D_linkage>(points), test, "ward.D");
+      expect(nnchain<ward_D2_linkage>(points, threads) == nnchain<ward_D2_linkage>(points), test, "ward.D2");
+    }
+}
+
+static void test_workspace() {
+  const char * test = "a workspace reused over calls of different sizes and methods gives the same results";
+  struct hclust1d_workspace * workspace = hclust1d_workspace_new();
+  expect(workspace != NULL, test, "workspace");
+
+  for (int points_size: {1000, 10, 100000, 2, 3000})
+    for (int method = HCLUST1D_SINGLE_IMPLEMENTED_BY_HEAP; method <= HCLUST1D_SINGLE; method++) {
+      std::vector<double> points = random_points(points_size, points_size / 10, points_size + method);
+      dendrogram reusing(points_size), allocating(points_size), threaded(points_size);
+      expect(cluster(points, method, workspace, reusing) == HCLUST1D_OK, test, "status");
+      expect(cluster(points, method, NULL, allocating) == HCLUST1D_OK, test, "status without a workspace");
+      expect(reusing == allocating, test, "results");
+      cluster(points, method, workspace, threaded, 4);
+      expect(threaded == allocating, test, "results on 4 threads");
+    }
+
+  hclust1d_workspace_delete(workspace);
+}
+
+//the methods clustered together, each into its own dendrogram
+static int cluster_methods(const std::vector<double> & points, const std::vector<int> & methods,
+                           struct hclust1d_workspace * workspace, std::vector<dendrogram> & d, int threads = 1) {
+  std::vector<int *> merge_left, merge_right;
+  std::vector<double *> height;
+  for (dendrogram & method_d: d) {
+    merge_left.push_back(method_d.merge_left.data());
+    merge_right.push_back(method_d.merge_right.data());
+    height.push_back(method_d.height.data());
+  }
+  int status = hclust1d_cluster_methods(points.data(), points.size(), methods.data(), methods.size(), threads, workspace,
+                                        merge_left.data(), merge_right.data(), height.data(), d.front().order.data());
+  for (dendrogram & method_d: d)
+    method_d.order = d.front().order;   //shared
+  return status;
+}
+
+static void test_methods() {
+  const char * test = "several methods over a single sort give the same results as each method alone";
+  std::vector<int> methods;
+  for (int method = HCLUST1D_SINGLE; method >= HCLUST1D_SINGLE_IMPLEMENTED_BY_HEAP; method--)
+    methods.push_back(method);
+  struct hclust1d_workspace * workspace = hclust1d_workspace_new();
+
+  for (int points_size: {2, 1000, 100000}) {
+    std::vector<double> points = random_points(points_size, points_size / 10, 3 * points_size);
+    for (int threads: {1, 3, 16}) {
+      std::vector<dendrogram> together(methods.size(), dendrogram(points_size));
+      expect(cluster_methods(points, methods, threads == 3 ? workspace : NULL, together, threads) == HCLUST1D_OK, test, "status");
+      for (size_t m = 0; m < methods.size(); m++) {
+        dendrogram alone(points_size);
+        cluster(points, methods[m], NULL, alone);
+        expect(together[m] == alone, test, "results");
+      }
+    }
+  }
+
+  std::vector<dendrogram> d(2, dendrogram(3));
+  expect(cluster_methods({1.0, 3.0, 2.0}, {HCLUST1D_WARD_D2, HCLUST1D_WARD_D2}, NULL, d) == HCLUST1D_UNSUPPORTED_METHOD,
+         test, "a repeated method");
+  expect(cluster_methods({1.0, 3.0, 2.0}, {HCLUST1D_WARD_D2, 10}, NULL, d) == HCLUST1D_UNSUPPORTED_METHOD,
+         test, "an unsupported method");
+  expect(cluster_methods({1.0, std::nan(""), 2.0}, {HCLUST1D_WARD_D2, HCLUST1D_SINGLE}, NULL, d) == HCLUST1D_NOT_FINITE,
+         test, "NaN");
+
+  hclust1d_workspace_delete(workspace);
+}
+
+//the memberships in k clusters of the first points_size - k merges of a dendrogram, numbered from the lowest cluster
+static std::vector<int> cut(const dendrogram & d, const std::vector<double> & points, int k) {
+  int points_size = points.size();
+  std::vector<int> parent(points_size);
+  for (int i = 0; i < points_size; i++)
+    parent[i] = i;
+  auto root = [&](int i) {
+    while (parent[i] != i)
+      i = parent[i] = parent[parent[i]];
+    return i;
+  };
+  std::vector<int> stage_point(points_size - 1);   //a point of the cluster merged at each stage
+  auto point = [&](int merged) { return merged < 0 ? -merged - 1 : stage_point[merged - 1]; };
+  for (int stage = 0; stage < points_size - k; stage++) {
+    stage_point[stage] = point(d.merge_left[stage]);
+    parent[root(point(d.merge_right[stage]))] = root(stage_point[stage]);
+  }
+
+  std::vector<int> memberships(points_size), numbers(points_size, 0);
+  int clusters = 0;
+  for (int i: d.order) {
+    if (numbers[root(i)] == 0)
+      numbers[root(i)] = ++clusters;
+    memberships[i] = numbers[root(i)];
+  }
+  return memberships;
+}
+
+static void test_bootstrap() {
+  const char * test = "bootstrap resamples give the memberships of the dendrograms of the resamples";
+  int points_size = 300, resamples = 24, k = 4;
+  std::vector<double> points = random_points(points_size, 100, 23);
+  const std::uint32_t seed[bootstrap_seed_size] = {2024, 7};
+
+  for (int method = HCLUST1D_SINGLE_IMPLEMENTED_BY_HEAP; method <= HCLUST1D_SINGLE; method++) {
+    std::vector<int> memberships(points_size * resamples), counts(points_size * resamples);
+    bootstrap_clusters(points.data(), points_size, resamples, method, k, seed, 1, 0, memberships.data(), counts.data(), NULL);
+
+    std::vector<int> threaded(points_size * resamples);
+    bootstrap_clusters(points.data(), points_size, resamples, method, k, seed, 5, 0, threaded.data(), NULL, NULL);
+    expect(threaded == memberships, test, "memberships on 5 threads");
+
+    for (int resample = 0; resample < resamples; resample++) {
+      std::vector<int> resample_counts(points_size);
+      bootstrap_counts(points_size, seed, resample, resample_counts.data());
+      expect(std::equal(resample_counts.begin(), resample_counts.end(), counts.begin() + resample * points_size), test, "counts");
+
+      std::vector<double> resampled;
+      std::vector<int> copies;   //of the point of each resampled one
+      for (int i = 0; i < points_size; i++)
+        for (int copy = 0; copy < resample_counts[i]; copy++) {
+          resampled.push_back(points[i]);
+          copies.push_back(i);
+        }
+      expect((int)resampled.size() == points_size, test, "resample size");
+
+      dendrogram d(points_size);
+      cluster(resampled, method, NULL, d);
+      std::vector<int> expected = cut(d, resampled, k);
+      bool same = true;
+      for (int r = 0; r < points_size; r++)
+        same = same and memberships[resample * points_size + copies[r]] == expected[r];
+      for (int i = 0; i < points_size; i++)
+        same = same and (memberships[resample * points_size + i] == 0) == (resample_counts[i] == 0);
+      expect(same, test, "memberships");
+    }
+
+    std::vector<double> coclustering(points_size * points_size);
+    bootstrap_clusters(points.data(), points_size, resamples, method, k, seed, 3, 0, NULL, NULL, coclustering.data());
+    bool same = true;
+    for (int i = 0; i < points_size; i++)
+      for (int j = 0; j < points_size; j++) {
+        int drawn = 0, together = 0;
+        for (int resample = 0; resample < resamples; resample++) {
+          int a = memberships[resample * points_size + i], b = memberships[resample * points_size + j];
+          drawn += a > 0 and b > 0;
+          together += a > 0 and a == b;
+        }
+        double frequency = coclustering[i * points_size + j];
+        same = same and (drawn > 0 ? frequency == (double)together / drawn : frequency != frequency);
+      }
+    expect(same, test, "co-clustering frequencies");
+  }
+}
+
+static void test_cut_index() {
+  const char * test = "the cut index assigns the points as cutree does, and new points to the nearest point";
+  const int missing = -1;
+
+  std::mt19937 generator(43);
+  std::normal_distribution<double> normal(0.0, 3.0);
+  std::vector<double> new_points(100000);
+  for (double & point: new_points)
+    point = normal(generator);
+  new_points[7] = std::nan("");
+
+  for (const std::vector<double> & points: {random_points(5000, 300, 41), random_points(3000, 0, 42), {8, 1, 4, 2}})
+    for (int method: {HCLUST1D_SINGLE, HCLUST1D_COMPLETE, HCLUST1D_CENTROID}) {
+      int points_size = points.size();
+      dendrogram d(points_size);
+      cluster(points, method, NULL, d);
+      std::vector<int> ks = {1, 2, 3, std::min(10, points_size), std::min(250, points_size)};
+      cut_index index;
+      make_cut_index(points.data(), points_size, d.merge_left.data(), d.merge_right.data(), ks, index);
+
+      std::vector<double> sorted = points;
+      std::sort(sorted.begin(), sorted.end());
+      for (size_t l = 0; l < ks.size(); l++) {
+        //numbered by the first appearance of the clusters in the points, as in cutree()
+        std::vector<int> expected = cut(d, points, ks[l]), numbers(ks[l] + 1, 0);
+        int numbered = 0;
+        for (int & membership: expected) {
+          if (numbers[membership] == 0)
+            numbers[membership] = ++numbered;
+          membership = numbers[membership];
+        }
+        std::vector<int> clusters(points_size);
+        assign_clusters(index.levels[l], points.data(), points_size, clusters.data(), missing);
+        expect(clusters == expected, test, "the points clustered");
+
+        //the cluster of each sorted point, and so of the nearest point (to the right at a midpoint)
+        std::vector<int> sorted_clusters(points_size);
+        for (int i = 0; i < points_size; i++)
+          sorted_clusters[i] = expected[d.order[i]];
+        std::vector<int> nearest(new_points.size());
+        for (size_t i = 0; i < new_points.size(); i++) {
+          int right = std::upper_bound(sorted.begin(), sorted.end(), new_points[i]) - sorted.begin();
+          if (right == points_size or (right > 0 and sorted[right - 1] / 2 + sorted[right] / 2 > new_points[i]))
+            right--;
+          nearest[i] = std::isnan(new_points[i]) ? missing : sorted_clusters[right];
+        }
+        for (int threads: {1, 4}) {
+          std::vector<int> new_clusters(new_points.size());
+          assign_clusters(index.levels[l], new_points.data(), new_points.size(), new_clusters.data(), missing, threads);
+          expect(new_clusters == nearest, test, threads == 1 ? "new points" : "new points on threads");
+        }
+      }
+    }
+
+  std::vector<int> merge_left = {-1, 1}, merge_right = {-3, -2};   //1 and 3 merged first
+  cut_index index;
+  for (int stage: {0, 1}) {
+    bool thrown = false;
+    try {
+      make_cut_index(std::vector<double>({1.0, 2.0, 3.0}).data(), 3, merge_left.data(), merge_right.data(), {2}, index);
+    } catch (std::invalid_argument &) {
+      thrown = true;
+    }
+    expect(thrown, test, stage == 0 ? "clusters not contiguous" : "merges not of a dendrogram");
+    merge_left = {-1, 2};   //the stage 1 merged at the stage 1
+  }
+}
+
+//the doubles of a file
+static std::vector<double> read_doubles(const char * path) {
+  std::vector<double> values;
+  std::FILE * file = std::fopen(path, "rb");
+  if (file == NULL)
+    return values;
+  for (double value; std::fread(&value, sizeof(double), 1, file) == 1; )
+    values.push_back(value);
+  std::fclose(file);
+  return values;
+}
+
+static void write_doubles(const char * path, const std::vector<double> & values) {
+  std::FILE * file = std::fopen(path, "wb");
+  std::fwrite(values.data(), sizeof(double), values.size(), file);
+  std::fclose(file);
+}
+
+static void test_single_file() {
+  const char * test = "single linkage out of core gives the same results as in memory";
+  const char * points_path = "test_core_points.bin";
+  const char * merges_path = "test_core_merges.bin";
+  const char * order_path = "test_core_order.bin";
+
+  std::vector<std::vector<double> > inputs = {random_points(100000, 0, 21), random_points(50000, 100, 22), {8, 1, 4, 2}};
+  inputs.push_back(std::vector<double>(30000));
+  for (size_t i = 0; i < inputs.back().size(); i++)
+    inputs.back()[i] = -(double)i * i;   //reversed, with decreasing gaps: the stack grows to all the intervals
+
+  for (const std::vector<double> & points: inputs)
+    for (long long memory: {1LL << 30, 1LL << 13}) {   //in memory, and in many runs merged in many passes
+      write_doubles(points_path, points);
+      dendrogram expected(points.size());
+      cluster(points, HCLUST1D_SINGLE, NULL, expected);
+
+      int status = hclust1d_cluster_file(points_path, HCLUST1D_SINGLE, merges_path, order_path, memory, ".");
+      expect(status == HCLUST1D_OK, test, "status");
+      std::vector<double> rows = read_doubles(merges_path);
+      std::vector<double> order = read_doubles(order_path);
+      expect(rows.size() == 3 * expected.height.size() and order.size() == points.size(), test, "sizes");
+      if (rows.size() != 3 * expected.height.size() or order.size() != points.size())
+        continue;
+
+      dendrogram d(points.size());
+      for (size_t stage = 0; stage < expected.height.size(); stage++) {
+        d.merge_left[stage] = (int)rows[3 * stage];
+        d.merge_right[stage] = (int)rows[3 * stage + 1];
+        d.height[stage] = rows[3 * stage + 2];
+      }
+      for (size_t i = 0; i < points.size(); i++)
+        d.order[i] = (int)order[i] - 1;
+      expect(d == expected, test, memory > (1LL << 13) ? "in memory" : "out of memory");
+    }
+
+  write_doubles(points_path, {1.0});
+  expect(hclust1d_cluster_file(points_path, HCLUST1D_SINGLE, merges_path, NULL, 1 << 20, ".") == HCLUST1D_TOO_FEW_POINTS,
+         test, "one point");
+  write_doubles(points_path, {1.0, std::nan(""), 2.0});
+  expect(hclust1d_cluster_file(points_path, HCLUST1D_SINGLE, merges_path, NULL, 1 << 20, ".") == HCLUST1D_NOT_FINITE,
+         test, "NaN");
+  expect(hclust1d_cluster_file(points_path, HCLUST1D_COMPLETE, merges_path, NULL, 1 << 20, ".") == HCLUST1D_UNSUPPORTED_METHOD,
+         test, "method");
+  expect(hclust1d_cluster_file("test_core_missing.bin", HCLUST1D_SINGLE, merges_path, NULL, 1 << 20, ".") == HCLUST1D_FILE_ERROR,
+         test, "missing file");
+
+  std::remove(points_path);
+  std::remove(merges_path);
+  std::remove(order_path);
+}
+
+//the dendrogram of a file, with the order 0-based again
+static dendrogram read_dendrogram(dendrogram_file & file) {
+  int points_size = file.points_size();
+  dendrogram d(points_size);
+  d.merge_left.assign(file.merge_left(), file.merge_left() + points_size - 1);
+  d.merge_right.assign(file.merge_right(), file.merge_right() + points_size - 1);
+  d.height.assign(file.height(), file.height() + points_size - 1);
+  for (int i = 0; i < points_size; i++)
+    d.order[i] = file.order()[i] - 1;
+  return d;
+}
+
+static bool file_exists(const std::string & path) {
+  std::FILE * file = std::fopen(path.c_str(), "rb");
+  if (file != NULL)
+    std::fclose(file);
+  return file != NULL;
+}
+
+static void test_dendrogram_file() {
+  const char * test = "a dendrogram file written from the merge loop reads back the same dendrogram";
+  const char * path = "test_core_dendrogram.bin";
+
+  std::vector<double> points = random_points(20000, 500, 31);
+  for (int method = HCLUST1D_SINGLE_IMPLEMENTED_BY_HEAP; method <= HCLUST1D_SINGLE; method++) {
+    dendrogram expected(points.size());
+    cluster(points, method, NULL, expected);
+    expect(hclust1d_cluster_save(points.data(), points.size(), method, 2, NULL, path, method % 2) == HCLUST1D_OK, test, "status");
+
+    dendrogram_file file(path);
+    expect(read_dendrogram(file) == expected, test, "dendrogram");
+    expect(file.labels() == (method % 2 ? value_dendrogram_labels : no_dendrogram_labels), test, "labels");
+    if (file.labels() == value_dendrogram_labels)
+      expect(std::vector<double>(file.label_values(), file.label_values() + points.size()) == points, test, "values");
+    expect(std::string(file.header.dist_method) == "euclidean", test, "dist.method");
+  }
+  expect(not file_exists(std::string(path) + ".partial"), test, "no partial file");
+
+  //string labels, written by hand as in R
+  {
+    dendrogram expected(4);
+    cluster({8, 1, 4, 2}, HCLUST1D_COMPLETE, NULL, expected);
+    std::vector<std::string> labels = {"eight", "", "four", "two"};
+    dendrogram_file written(path, 4, string_dendrogram_labels, 12);
+    for (int stage = 0; stage < 3; stage++) {
+      written.merge_left()[stage] = expected.merge_left[stage];
+      written.merge_right()[stage] = expected.merge_right[stage];
+      written.height()[stage] = expected.height[stage];
+    }
+    written.label_offsets()[0] = 0;
+    for (int i = 0; i < 4; i++) {
+      written.order()[i] = expected.order[i] + 1;
+      std::copy(labels[i].begin(), labels[i].end(), written.label_bytes() + written.label_offsets()[i]);
+      written.label_offsets()[i + 1] = written.label_offsets()[i] + labels[i].size();
+    }
+    written.finish("complete", "manhattan");
+
+    dendrogram_file file(path);
+    expect(read_dendrogram(file) == expected, test, "dendrogram with string labels");
+    expect(std::string(file.header.method) == "complete" and std::string(file.header.dist_method) == "manhattan", test, "methods");
+    for (int i = 0; i < 4; i++) {
+      const char * bytes;
+      std::int64_t length;
+      expect(file.label(i, bytes, length) and std::string(bytes, length) == labels[i], test, "string labels");
+    }
+
+    //a new dendrogram saved over the file leaves the one mapped intact
+    expect(hclust1d_cluster_save(points.data(), points.size(), HCLUST1D_SINGLE, 1, NULL, path, 0) == HCLUST1D_OK, test, "status");
+    expect(read_dendrogram(file) == expected, test, "mapped while saved over");
+    expect(dendrogram_file(path).points_size() == (std::int64_t) points.size(), test, "saved over");
+  }
+
+  //an unfinished file is removed, and no file of another format is taken for a dendrogram
+  {
+    dendrogram_file unfinished(path, 1000, no_dendrogram_labels);
+  }
+  expect(not file_exists(std::string(path) + ".partial"), test, "unfinished file removed");
+  for (const std::vector<double> & content: {std::vector<double>(100, 1.0), std::vector<double>(2, 1.0)}) {
+    write_doubles(path, content);
+    bool thrown = false;
+    try {
+      dendrogram_file file(path);
+    } catch (file_error &) {
+      thrown = true;
+    }
+    expect(thrown, test, "not a dendrogram");
+  }
+  expect(hclust1d_cluster_save(points.data(), points.size(), HCLUST1D_COMPLETE, 1, NULL, "test_core_missing/dendrogram.bin", 0)
+         == HCLUST1D_FILE_ERROR, test, "missing directory");
+  expect(hclust1d_cluster_save(points.data(), points.size(), 10, 1, NULL, path, 0) == HCLUST1D_UNSUPPORTED_METHOD, test, "method");
+
+  std::remove(path);
+}
+
+static void test_errors() {
+  const char * test = "the C interface returns an error status for wrong input";
+  dendrogram d(3);
+  expect(cluster({1.0}, HCLUST1D_COMPLETE, NULL, d) == HCLUST1D_TOO_FEW_POINTS, test, "one point");
+  expect(cluster({1.0, std::nan(""), 2.0}, HCLUST1D_COMPLETE, NULL, d) == HCLUST1D_NOT_FINITE, test, "NaN");
+  expect(cluster({1.0, 1.0 / 0.0, 2.0}, HCLUST1D_SINGLE, NULL, d) == HCLUST1D_NOT_FINITE, test, "infinity");
+  expect(cluster({1.0, 3.0, 2.0}, 10, NULL, d) == HCLUST1D_UNSUPPORTED_METHOD, test, "method");
+  expect(cluster({1.0, 3.0, 2.0}, -1, NULL, d) == HCLUST1D_UNSUPPORTED_METHOD, test, "negative method");
+}
+
+int main() {
+  test_small_example();
+  test_heap();
+  test_queue_backends();
+  test_engines();
+  test_large_ward();
+  test_nnchain_rounds();
+  test_workspace();
+  test_methods();
+  test_bootstrap();
+  test_cut_index();
+  test_single_file();
+  test_dendrogram_file();
+  test_errors();
+
+  if (failures > 0)
+    std::printf("%d failures\n", failures);
+  return failures > 0 ? 1 : 0;
+}